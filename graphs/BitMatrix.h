@@ -0,0 +1,278 @@
+//
+// Square matrix of bits, one row of 64-bit words per vertex.
+// The static helpers work on any word arrays of the same length (rows, frontiers,
+// visited sets) and use AVX2 or SSE2 when the compiler targets them. Without
+// AVX2, GCC and Clang on x86 compile the popcount loops a second time for POPCNT
+// and take that copy when the CPU has it, so the baseline build does not fall
+// back to the bit-twiddling __builtin_popcountll.
+//
+
+#ifndef UNTITLED2_BITMATRIX_H
+#define UNTITLED2_BITMATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if !defined(__AVX2__) && !defined(__POPCNT__) && !defined(_MSC_VER) && (defined(__x86_64__) || defined(__i386__))
+#define BITMATRIX_POPCNT_DISPATCH
+#endif
+
+class BitMatrix {
+private:
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t words_per_row_ = 0;
+    std::vector<uint64_t> words_;
+
+#if defined(__AVX2__)
+    // Bytewise popcount through a nibble lookup, summed into four 64-bit lanes
+    static __m256i PopCount256(__m256i v) {
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low_mask = _mm256_set1_epi8(0x0f);
+        __m256i low = _mm256_and_si256(v, low_mask);
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+        return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+    }
+
+    static size_t SumLanes(__m256i v) {
+        return static_cast<size_t>(_mm256_extract_epi64(v, 0) + _mm256_extract_epi64(v, 1) +
+                                   _mm256_extract_epi64(v, 2) + _mm256_extract_epi64(v, 3));
+    }
+#endif
+
+#if defined(BITMATRIX_POPCNT_DISPATCH)
+    static bool HasPopcnt() {
+        return __builtin_cpu_supports("popcnt");
+    }
+
+    __attribute__((target("popcnt"))) static size_t CountPopcnt(const uint64_t* a, size_t words) {
+        size_t count = 0;
+        for (size_t i = 0; i < words; ++i) {
+            count += static_cast<size_t>(__builtin_popcountll(a[i]));
+        }
+        return count;
+    }
+
+    __attribute__((target("popcnt"))) static size_t IntersectionCountPopcnt(const uint64_t* a, const uint64_t* b,
+                                                                             size_t words) {
+        size_t count = 0;
+        for (size_t i = 0; i < words; ++i) {
+            count += static_cast<size_t>(__builtin_popcountll(a[i] & b[i]));
+        }
+        return count;
+    }
+#endif
+
+public:
+    BitMatrix() = default;
+
+    BitMatrix(size_t rows, size_t cols)
+            : rows_(rows), cols_(cols), words_per_row_((cols + 63) / 64), words_(rows * ((cols + 63) / 64), 0) {}
+
+    void set(size_t row, size_t col) {
+        words_[row * words_per_row_ + col / 64] |= uint64_t{1} << (col % 64);
+    }
+
+    void reset(size_t row, size_t col) {
+        words_[row * words_per_row_ + col / 64] &= ~(uint64_t{1} << (col % 64));
+    }
+
+    [[nodiscard]] bool test(size_t row, size_t col) const {
+        return (words_[row * words_per_row_ + col / 64] >> (col % 64)) & 1;
+    }
+
+    [[nodiscard]] const uint64_t* row(size_t row) const {
+        return words_.data() + row * words_per_row_;
+    }
+
+    [[nodiscard]] size_t rows() const {
+        return rows_;
+    }
+
+    [[nodiscard]] size_t cols() const {
+        return cols_;
+    }
+
+    [[nodiscard]] size_t words_per_row() const {
+        return words_per_row_;
+    }
+
+    [[nodiscard]] size_t bytes() const {
+        return words_.size() * sizeof(uint64_t);
+    }
+
+    [[nodiscard]] bool empty() const {
+        return words_.empty();
+    }
+
+    static size_t PopCount(uint64_t word) {
+#if defined(_MSC_VER)
+        return static_cast<size_t>(__popcnt64(word));
+#else
+        return static_cast<size_t>(__builtin_popcountll(word));
+#endif
+    }
+
+    // Index of the lowest set bit; `word` must not be zero
+    static size_t LowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return index;
+#else
+        return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+    }
+
+    // |a|
+    static size_t Count(const uint64_t* a, size_t words) {
+#if defined(BITMATRIX_POPCNT_DISPATCH)
+        if (HasPopcnt()) {
+            return CountPopcnt(a, words);
+        }
+#endif
+        size_t count = 0;
+        size_t i = 0;
+#if defined(__AVX2__)
+        __m256i sums = _mm256_setzero_si256();
+        for (; i + 4 <= words; i += 4) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            sums = _mm256_add_epi64(sums, PopCount256(va));
+        }
+        count = SumLanes(sums);
+#endif
+        for (; i < words; ++i) {
+            count += PopCount(a[i]);
+        }
+        return count;
+    }
+
+    // |a & b| without materializing the intersection
+    static size_t IntersectionCount(const uint64_t* a, const uint64_t* b, size_t words) {
+#if defined(BITMATRIX_POPCNT_DISPATCH)
+        if (HasPopcnt()) {
+            return IntersectionCountPopcnt(a, b, words);
+        }
+#endif
+        size_t count = 0;
+        size_t i = 0;
+#if defined(__AVX2__)
+        __m256i sums = _mm256_setzero_si256();
+        for (; i + 4 <= words; i += 4) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            sums = _mm256_add_epi64(sums, PopCount256(_mm256_and_si256(va, vb)));
+        }
+        count = SumLanes(sums);
+#endif
+        for (; i < words; ++i) {
+            count += PopCount(a[i] & b[i]);
+        }
+        return count;
+    }
+
+    // a & b != 0
+    static bool Intersects(const uint64_t* a, const uint64_t* b, size_t words) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 4 <= words; i += 4) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            if (!_mm256_testz_si256(va, vb)) {
+                return true;
+            }
+        }
+#endif
+        for (; i < words; ++i) {
+            if (a[i] & b[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // dst = a & b
+    static void Intersect(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t words) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 4 <= words; i += 4) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(va, vb));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (; i + 2 <= words; i += 2) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(va, vb));
+        }
+#endif
+        for (; i < words; ++i) {
+            dst[i] = a[i] & b[i];
+        }
+    }
+
+    // dst = a | b
+    static void Unite(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t words) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 4 <= words; i += 4) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(va, vb));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (; i + 2 <= words; i += 2) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(va, vb));
+        }
+#endif
+        for (; i < words; ++i) {
+            dst[i] = a[i] | b[i];
+        }
+    }
+
+    // dst = a & ~b
+    static void Subtract(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t words) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 4 <= words; i += 4) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_andnot_si256(vb, va));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (; i + 2 <= words; i += 2) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_andnot_si128(vb, va));
+        }
+#endif
+        for (; i < words; ++i) {
+            dst[i] = a[i] & ~b[i];
+        }
+    }
+
+    // Calls f(index) for every set bit of a, in increasing order
+    template <typename F>
+    static void ForEachBit(const uint64_t* a, size_t words, F f) {
+        for (size_t i = 0; i < words; ++i) {
+            for (uint64_t word = a[i]; word != 0; word &= word - 1) {
+                f(i * 64 + LowestBit(word));
+            }
+        }
+    }
+};
+
+#endif //UNTITLED2_BITMATRIX_H
@@ -0,0 +1,98 @@
+//
+// Array that either owns its elements or views a region of a MappedFile (read-only
+// until Mutable() copies it out). The mapping may be anonymous memory that was
+// filled in place, e.g. pages put on chosen NUMA nodes by BasicGraph::place().
+//
+
+#ifndef UNTITLED2_BUFFER_H
+#define UNTITLED2_BUFFER_H
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "MappedFile.h"
+
+template <typename T>
+class Buffer {
+private:
+    std::vector<T> owned_;
+    // Set only for views; keeps the mapping alive for as long as any copy needs it
+    std::shared_ptr<const MappedFile> mapping_;
+    const T* mapped_ = nullptr;
+    size_t mapped_size_ = 0;
+
+public:
+    Buffer() = default;
+
+    Buffer(std::vector<T> values) : owned_(std::move(values)) {}
+
+    // View of `count` elements starting `offset` bytes into the mapping
+    static Buffer View(std::shared_ptr<const MappedFile> mapping, size_t offset, size_t count) {
+        if (offset % alignof(T) != 0 || offset > mapping->size() ||
+            count > (mapping->size() - offset) / sizeof(T)) {
+            throw std::runtime_error("Buffer outside of mapped file");
+        }
+        Buffer buffer;
+        buffer.mapped_ = reinterpret_cast<const T*>(mapping->data() + offset);
+        buffer.mapped_size_ = count;
+        buffer.mapping_ = std::move(mapping);
+        return buffer;
+    }
+
+    // Writable elements; a view is copied out of the mapping first
+    std::vector<T>& Mutable() {
+        if (mapping_) {
+            owned_.assign(mapped_, mapped_ + mapped_size_);
+            mapping_.reset();
+            mapped_ = nullptr;
+            mapped_size_ = 0;
+        }
+        return owned_;
+    }
+
+    // True for a view of a file; views of anonymous memory count as owned
+    [[nodiscard]] bool is_mapped() const {
+        return mapping_ != nullptr && !mapping_->is_anonymous();
+    }
+
+    [[nodiscard]] const T* data() const {
+        return mapping_ ? mapped_ : owned_.data();
+    }
+
+    [[nodiscard]] size_t size() const {
+        return mapping_ ? mapped_size_ : owned_.size();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return size() == 0;
+    }
+
+    // Asks for elements [first, first + count) to be read in; a no-op unless this
+    // is a view of a file
+    void prefetch(size_t first, size_t count) const {
+        if (is_mapped()) {
+            mapping_->Prefetch(mapped_ + first, count * sizeof(T));
+        }
+    }
+
+    // Heap bytes held, or bytes viewed in the mapping for a view
+    [[nodiscard]] size_t bytes() const {
+        return (mapping_ ? mapped_size_ : owned_.capacity()) * sizeof(T);
+    }
+
+    const T& operator[](size_t i) const {
+        return data()[i];
+    }
+
+    [[nodiscard]] const T* begin() const {
+        return data();
+    }
+
+    [[nodiscard]] const T* end() const {
+        return data() + size();
+    }
+};
+
+#endif //UNTITLED2_BUFFER_H
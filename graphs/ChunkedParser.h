@@ -0,0 +1,135 @@
+//
+// Splits a text buffer into line-aligned chunks and parses them on several threads.
+// ForEach() runs any other per-part work on the same threads.
+//
+
+#ifndef UNTITLED2_CHUNKEDPARSER_H
+#define UNTITLED2_CHUNKEDPARSER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class ChunkedParser {
+public:
+    struct Chunk {
+        const char* begin;
+        const char* end;
+    };
+
+    // Chunks smaller than this are not worth a thread of their own
+    static constexpr size_t kMinChunkBytes = 1 << 20;
+
+    // Cuts [begin, end) into at most `threads` pieces, each ending right after a '\n'
+    // (or at `end`), so that no line is split between two chunks.
+    static std::vector<Chunk> Split(const char* begin, const char* end, unsigned threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        size_t bytes = end - begin;
+        size_t count = std::max<size_t>(1, std::min<size_t>(threads, bytes / kMinChunkBytes));
+        std::vector<Chunk> chunks;
+        chunks.reserve(count);
+        const char* start = begin;
+        for (size_t i = 1; i <= count && start < end; ++i) {
+            const char* stop = i == count ? end : begin + bytes * i / count;
+            if (stop < start) {
+                stop = start;
+            }
+            while (stop < end && stop > begin && stop[-1] != '\n') {
+                ++stop;
+            }
+            chunks.push_back({start, stop});
+            start = stop;
+        }
+        if (chunks.empty()) {
+            chunks.push_back({begin, end});
+        }
+        return chunks;
+    }
+
+    // Runs parse(index, chunk) for every chunk, one thread per chunk. The first
+    // exception thrown by any worker is rethrown on the calling thread.
+    template <typename Parse>
+    static void Run(const std::vector<Chunk>& chunks, Parse parse) {
+        ForEach(chunks.size(), [&](size_t i) { parse(i, chunks[i]); }, chunks.size());
+    }
+
+    // Runs work(i) for i = 0..count-1 on at most `threads` threads (0: one per
+    // hardware thread), thread t taking i = t, t + threads, ... The calling
+    // thread is one of them; the first exception is rethrown on it.
+    template <typename Work>
+    static void ForEach(size_t count, Work work, size_t threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = std::min(threads, count);
+        std::vector<std::exception_ptr> errors(threads);
+        auto run = [&](size_t t) {
+            try {
+                for (size_t i = t; i < count; i += threads) {
+                    work(i);
+                }
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (size_t t = 1; t < threads; ++t) {
+            workers.emplace_back(run, t);
+        }
+        if (threads > 0) {
+            run(0);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // Skips blanks (but not '\n'); '\r' counts as a blank so CRLF files parse too
+    static const char* SkipBlanks(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+            ++p;
+        }
+        return p;
+    }
+
+    static const char* SkipWhitespace(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            ++p;
+        }
+        return p;
+    }
+
+    static const char* NextLine(const char* p, const char* end) {
+        while (p < end && *p != '\n') {
+            ++p;
+        }
+        return p < end ? p + 1 : end;
+    }
+
+    // Parses one number at p; returns nullptr if there is none
+    template <typename T>
+    static const char* ParseNumber(const char* p, const char* end, T& value) {
+        if (p < end && *p == '+') {
+            ++p;
+        }
+        auto [next, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc()) {
+            return nullptr;
+        }
+        return next;
+    }
+};
+
+#endif //UNTITLED2_CHUNKEDPARSER_H
@@ -0,0 +1,350 @@
+//
+// Read-only graph with gap-encoded neighbour lists in Stream VByte format.
+//
+// Row u stores the gaps between consecutive sorted neighbours (the first one
+// relative to 0) as 1-4 byte integers. Control bytes for the whole row come first,
+// two bits per value giving its length, followed by the data bytes. Decoding
+// turns one control byte into four neighbours with a single SSSE3 shuffle and a
+// prefix sum; other targets use the scalar loop. A build for the x86 baseline
+// compiles the SSSE3 decoder on its own and calls it when the CPU has SSSE3.
+//
+// Built from any BasicGraph<W>. A BINARY snapshot loaded with CSR storage stays
+// mapped, so graphs larger than RAM can be compressed row by row.
+//
+
+#ifndef UNTITLED2_COMPRESSEDGRAPH_H
+#define UNTITLED2_COMPRESSEDGRAPH_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "Graph.h"
+
+#if !defined(__SSSE3__) && !defined(_MSC_VER) && (defined(__x86_64__) || defined(__i386__))
+#define COMPRESSEDGRAPH_SSSE3_DISPATCH
+#endif
+#if defined(__SSSE3__) || defined(COMPRESSEDGRAPH_SSSE3_DISPATCH)
+#include <tmmintrin.h>
+#endif
+
+template <typename W>
+class BasicCompressedGraph {
+public:
+    using Traits = WeightTraits<W>;
+    using weight_type = typename Traits::value_type;
+    using distance_type = typename Traits::distance_type;
+    using Neighbor = typename BasicGraph<W>::Neighbor;
+
+    // Decodes one row on the fly, up to 16 neighbours at a time
+    class NeighborRange {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Neighbor;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Neighbor;
+
+            iterator() = default;
+
+            iterator(const uint8_t* control, const uint8_t* data, const weight_type* weight, uint32_t count)
+                    : control_(control), data_(data), weight_(weight), remaining_(count) {
+                if (remaining_ != 0) {
+                    Refill();
+                }
+            }
+
+            Neighbor operator*() const {
+                if constexpr (Traits::kStored) {
+                    return {static_cast<int>(block_[index_]), *weight_};
+                } else {
+                    return {static_cast<int>(block_[index_]), 1};
+                }
+            }
+            iterator& operator++() {
+                --remaining_;
+                if constexpr (Traits::kStored) {
+                    ++weight_;
+                }
+                if (++index_ == kBatch && remaining_ != 0) {
+                    Refill();
+                }
+                return *this;
+            }
+            iterator operator++(int) {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+            // Iterators of one row differ only in how many neighbours are left
+            bool operator==(const iterator& other) const { return remaining_ == other.remaining_; }
+            bool operator!=(const iterator& other) const { return remaining_ != other.remaining_; }
+
+        private:
+            // Neighbours decoded at once: four control bytes, so that the call
+            // into the decoder is paid once per 16 arcs
+            static constexpr uint32_t kBatch = 16;
+
+            const uint8_t* control_ = nullptr;
+            const uint8_t* data_ = nullptr;
+            const weight_type* weight_ = nullptr;
+            uint32_t remaining_ = 0;
+            uint32_t index_ = 0;
+            uint32_t previous_ = 0;
+            uint32_t block_[kBatch] = {};
+
+            void Refill() {
+                // Only the control bytes of this row, so nothing past its padding is read
+                uint32_t blocks = std::min<uint32_t>(kBatch / 4, (remaining_ + 3) / 4);
+                data_ = DecodeBlocks(control_, data_, previous_, block_, blocks);
+                control_ += blocks;
+                previous_ = block_[blocks * 4 - 1];
+                index_ = 0;
+            }
+        };
+
+        NeighborRange(const uint8_t* control, const uint8_t* data, const weight_type* weights, uint32_t count)
+                : control_(control), data_(data), weights_(weights), count_(count) {}
+
+        [[nodiscard]] iterator begin() const { return {control_, data_, weights_, count_}; }
+        [[nodiscard]] iterator end() const { return {}; }
+        [[nodiscard]] size_t size() const { return count_; }
+        [[nodiscard]] bool empty() const { return count_ == 0; }
+
+    private:
+        const uint8_t* control_;
+        const uint8_t* data_;
+        const weight_type* weights_;
+        uint32_t count_;
+    };
+
+private:
+    // A decoder may read up to 16 bytes past the last value of a row
+    static constexpr size_t kPadding = 16;
+
+    int size_{};
+    bool is_directed_{};
+    // Row u: control bytes at bytes_[row_offsets_[u]], then its data bytes
+    std::vector<uint64_t> row_offsets_;
+    // Arcs of u are arc_offsets_[u] .. arc_offsets_[u + 1]; also indexes weights_
+    std::vector<uint64_t> arc_offsets_;
+    std::vector<uint8_t> bytes_;
+    std::vector<weight_type> weights_;  // empty for Unweighted
+    std::shared_ptr<IdMap> ids_;
+
+    struct Tables {
+        // shuffle[c] moves the data bytes selected by control byte c into four
+        // little-endian 32-bit lanes; length[c] is how many data bytes they take
+        uint8_t shuffle[256][16];
+        uint8_t length[256];
+
+        Tables() {
+            for (int c = 0; c < 256; ++c) {
+                uint8_t pos = 0;
+                for (int k = 0; k < 4; ++k) {
+                    int bytes = ((c >> (2 * k)) & 3) + 1;
+                    for (int b = 0; b < 4; ++b) {
+                        shuffle[c][4 * k + b] = b < bytes ? pos++ : 0xFF;
+                    }
+                }
+                length[c] = pos;
+            }
+        }
+    };
+
+    static const Tables& GetTables() {
+        static const Tables tables;
+        return tables;
+    }
+
+    // Each decoder turns `blocks` control bytes into 4 * blocks absolute ids
+    // after `previous` and returns the next data byte
+#if defined(__SSSE3__) || defined(COMPRESSEDGRAPH_SSSE3_DISPATCH)
+#if defined(COMPRESSEDGRAPH_SSSE3_DISPATCH)
+    __attribute__((target("ssse3")))
+#endif
+    static const uint8_t* DecodeSsse3(const uint8_t* control, const uint8_t* data, uint32_t previous, uint32_t* out,
+                                      uint32_t blocks) {
+        const Tables& tables = GetTables();
+        __m128i base = _mm_set1_epi32(static_cast<int>(previous));
+        for (uint32_t k = 0; k < blocks; ++k) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.shuffle[control[k]]));
+            __m128i values = _mm_shuffle_epi8(bytes, shuffle);
+            values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+            values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+            values = _mm_add_epi32(values, base);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * k), values);
+            base = _mm_shuffle_epi32(values, 0xFF);
+            data += tables.length[control[k]];
+        }
+        return data;
+    }
+#endif
+
+    static const uint8_t* DecodeScalar(const uint8_t* control, const uint8_t* data, uint32_t previous, uint32_t* out,
+                                       uint32_t blocks) {
+        for (uint32_t k = 0; k < 4 * blocks; ++k) {
+            int bytes = ((control[k / 4] >> (2 * (k % 4))) & 3) + 1;
+            uint32_t gap = 0;
+            for (int b = 0; b < bytes; ++b) {
+                gap |= static_cast<uint32_t>(data[b]) << (8 * b);
+            }
+            data += bytes;
+            previous += gap;
+            out[k] = previous;
+        }
+        return data;
+    }
+
+    static const uint8_t* DecodeBlocks(const uint8_t* control, const uint8_t* data, uint32_t previous, uint32_t* out,
+                                       uint32_t blocks) {
+#if defined(__SSSE3__)
+        return DecodeSsse3(control, data, previous, out, blocks);
+#else
+#if defined(COMPRESSEDGRAPH_SSSE3_DISPATCH)
+        if (__builtin_cpu_supports("ssse3")) {
+            return DecodeSsse3(control, data, previous, out, blocks);
+        }
+#endif
+        return DecodeScalar(control, data, previous, out, blocks);
+#endif
+    }
+
+    static uint8_t GapBytes(uint32_t gap) {
+        return gap < (1u << 8) ? 1 : gap < (1u << 16) ? 2 : gap < (1u << 24) ? 3 : 4;
+    }
+
+    void CheckVertex(int v) const {
+        if (v < 1 || v > size_) {
+            throw std::out_of_range("Vertex index out of range");
+        }
+    }
+
+public:
+    explicit BasicCompressedGraph(const BasicGraph<W>& graph)
+            : size_(graph.size()), is_directed_(graph.is_directed()) {
+        row_offsets_.assign(size_ + 2, 0);
+        arc_offsets_.assign(size_ + 2, 0);
+        if constexpr (Traits::kStored) {
+            weights_.reserve(graph.arc_count());
+        }
+        std::vector<uint32_t> gaps;
+        for (int u = 1; u <= size_; ++u) {
+            gaps.clear();
+            int previous = 0;
+            for (auto [v, weight] : graph.neighbors(u)) {
+                gaps.push_back(static_cast<uint32_t>(v - previous));
+                previous = v;
+                if constexpr (Traits::kStored) {
+                    weights_.push_back(weight);
+                }
+            }
+            row_offsets_[u] = bytes_.size();
+            arc_offsets_[u + 1] = arc_offsets_[u] + gaps.size();
+
+            size_t control = bytes_.size();
+            bytes_.resize(control + (gaps.size() + 3) / 4, 0);
+            for (size_t i = 0; i < gaps.size(); ++i) {
+                uint8_t length = GapBytes(gaps[i]);
+                bytes_[control + i / 4] |= static_cast<uint8_t>((length - 1) << (2 * (i % 4)));
+                for (uint8_t b = 0; b < length; ++b) {
+                    bytes_.push_back(static_cast<uint8_t>(gaps[i] >> (8 * b)));
+                }
+            }
+        }
+        row_offsets_[size_ + 1] = bytes_.size();
+        bytes_.resize(bytes_.size() + kPadding, 0);
+        bytes_.shrink_to_fit();
+
+        if (graph.has_external_ids()) {
+            ids_ = std::make_shared<IdMap>(static_cast<size_t>(size_));
+            for (int v = 1; v <= size_; ++v) {
+                ids_->Insert(graph.external_id(v));
+            }
+        }
+    }
+
+    [[nodiscard]] int size() const {
+        return size_;
+    }
+
+    [[nodiscard]] bool is_directed() const {
+        return is_directed_;
+    }
+
+    [[nodiscard]] size_t arc_count() const {
+        return arc_offsets_[size_ + 1];
+    }
+
+    [[nodiscard]] int degree(int v) const {
+        CheckVertex(v);
+        return static_cast<int>(arc_offsets_[v + 1] - arc_offsets_[v]);
+    }
+
+    [[nodiscard]] NeighborRange neighbors(int v) const {
+        CheckVertex(v);
+        auto count = static_cast<uint32_t>(arc_offsets_[v + 1] - arc_offsets_[v]);
+        const uint8_t* control = bytes_.data() + row_offsets_[v];
+        const weight_type* weights = Traits::kStored ? weights_.data() + arc_offsets_[v] : nullptr;
+        return {control, control + (count + 3) / 4, weights, count};
+    }
+
+    // Decodes u's row up to v: O(deg)
+    [[nodiscard]] weight_type weight(int u, int v) const {
+        CheckVertex(v);
+        for (auto [w, value] : neighbors(u)) {
+            if (w >= v) {
+                return w == v ? value : 0;
+            }
+        }
+        return 0;
+    }
+
+    bool is_edge(int u, int v) const {
+        return weight(u, v) != 0;
+    }
+
+    [[nodiscard]] bool has_external_ids() const {
+        return ids_ != nullptr;
+    }
+
+    [[nodiscard]] int64_t external_id(int v) const {
+        CheckVertex(v);
+        return ids_ ? ids_->External(v) : v;
+    }
+
+    [[nodiscard]] int internal_id(int64_t id) const {
+        int v = 0;
+        if (ids_) {
+            v = ids_->Find(id);
+        } else if (id >= 1 && id <= size_) {
+            v = static_cast<int>(id);
+        }
+        if (v == 0) {
+            throw std::out_of_range("Unknown vertex id");
+        }
+        return v;
+    }
+
+    // Encoded neighbour lists, without the per-vertex offsets and the weights
+    [[nodiscard]] size_t adjacency_bytes() const {
+        return bytes_.size();
+    }
+
+    [[nodiscard]] size_t bytes() const {
+        return bytes_.size() + (row_offsets_.size() + arc_offsets_.size()) * sizeof(uint64_t) +
+               weights_.size() * sizeof(weight_type) + (ids_ ? ids_->bytes() : 0);
+    }
+};
+
+using CompressedGraph = BasicCompressedGraph<int>;
+
+#endif //UNTITLED2_COMPRESSEDGRAPH_H
@@ -0,0 +1,53 @@
+//
+// One value per edge, stored contiguously and indexed by edge id
+// (BasicGraph::out_edges, edge_id, reverse_edge). Each property of an
+// algorithm gets its own EdgeMap, so a pass over one property reads one array.
+//
+// The map is sized for the graph as it was when the map was made; edge ids, and
+// with them the map, are invalid after the graph changes.
+//
+
+#ifndef UNTITLED2_EDGEMAP_H
+#define UNTITLED2_EDGEMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+template <typename T>
+class EdgeMap {
+private:
+    std::vector<T> values_;
+
+public:
+    using reference = typename std::vector<T>::reference;
+    using const_reference = typename std::vector<T>::const_reference;
+
+    EdgeMap() = default;
+
+    template <typename G>
+    explicit EdgeMap(const G& graph, const T& value = T()) : values_(graph.edge_id_bound(), value) {}
+
+    reference operator[](size_t id) {
+        return values_[id];
+    }
+
+    const_reference operator[](size_t id) const {
+        return values_[id];
+    }
+
+    void fill(const T& value) {
+        std::fill(values_.begin(), values_.end(), value);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return values_.size();
+    }
+
+    [[nodiscard]] auto begin() { return values_.begin(); }
+    [[nodiscard]] auto end() { return values_.end(); }
+    [[nodiscard]] auto begin() const { return values_.begin(); }
+    [[nodiscard]] auto end() const { return values_.end(); }
+};
+
+#endif //UNTITLED2_EDGEMAP_H
@@ -0,0 +1,388 @@
+//
+// Seeded synthetic graphs for benchmarks: R-MAT, G(n, m), grids with blocked
+// cells, random geometric and power-law (Chung-Lu) graphs, and mazes for Map.
+//
+// Edges are produced in fixed-size chunks on several threads. Every chunk draws
+// from its own generator seeded by (seed, chunk), and per-cell or per-point
+// decisions hash (seed, index), so the graph depends only on the parameters and
+// the seed, never on the thread count. The result is built straight into a
+// BasicGraph<W>; save() writes it in any of the four input formats.
+//
+// Self-loops are never generated. Repeated pairs are merged as in an edge list,
+// so R-MAT and dense G(n, m) graphs end up with somewhat fewer edges than asked.
+//
+
+#ifndef UNTITLED2_GENERATORS_H
+#define UNTITLED2_GENERATORS_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "Graph.h"
+#include "map.h"
+
+struct GeneratorOptions {
+    uint64_t seed = 1;
+    // Weights are uniform in [1, max_weight]
+    int max_weight = 1;
+    // R-MAT, G(n, m) and power-law graphs only; grids and geometric graphs are undirected
+    bool directed = false;
+    GraphBase::Storage storage = GraphBase::AUTO;
+};
+
+class Generators {
+private:
+    // Edges generated per chunk; fixed so the output does not depend on the thread count
+    static constexpr size_t kChunkEdges = 1 << 16;
+
+    // splitmix64 finalizer
+    static uint64_t Mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    static uint64_t Hash(uint64_t seed, uint64_t index) {
+        return Mix(Mix(seed) ^ index);
+    }
+
+    // splitmix64 sequence; the same numbers on every platform, unlike <random> distributions
+    struct Random {
+        uint64_t state;
+
+        Random(uint64_t seed, uint64_t stream) : state(Hash(seed, stream)) {}
+
+        uint64_t Next() {
+            return Mix(state += 0x9E3779B97F4A7C15ull);
+        }
+
+        // Uniform in [0, n); the modulo bias is below 2^-32 for n < 2^32
+        uint64_t Below(uint64_t n) {
+            return Next() % n;
+        }
+
+        // Uniform in [0, 1)
+        double Uniform() {
+            return static_cast<double>(Next() >> 11) * 0x1.0p-53;
+        }
+    };
+
+    template <typename W>
+    using Edge = typename BasicGraph<W>::Edge;
+
+    template <typename W>
+    static typename BasicGraph<W>::weight_type DrawWeight(uint64_t bits, const GeneratorOptions& options) {
+        int max_weight = std::max(1, options.max_weight);
+        return static_cast<typename BasicGraph<W>::weight_type>(1 + bits % static_cast<uint64_t>(max_weight));
+    }
+
+    // Draws `count` pairs with pick(random, u, v) into preallocated slots; an
+    // undirected pair also gets its reverse arc right after it
+    template <typename W, typename Pick>
+    static std::vector<Edge<W>> DrawPairs(size_t count, const GeneratorOptions& options, Pick pick) {
+        size_t per_pair = options.directed ? 1 : 2;
+        std::vector<Edge<W>> edges(count * per_pair);
+        size_t chunks = (count + kChunkEdges - 1) / kChunkEdges;
+        ChunkedParser::ForEach(chunks, [&](size_t chunk) {
+            Random random(options.seed, chunk);
+            size_t first = chunk * kChunkEdges;
+            size_t last = std::min(count, first + kChunkEdges);
+            for (size_t k = first; k < last; ++k) {
+                int u, v;
+                do {
+                    pick(random, u, v);
+                } while (u == v);
+                auto weight = DrawWeight<W>(random.Next(), options);
+                edges[k * per_pair] = {u, v, weight};
+                if (per_pair == 2) {
+                    edges[k * per_pair + 1] = {v, u, weight};
+                }
+            }
+        });
+        return edges;
+    }
+
+    // Seeded shuffle of the vertex numbers, so that degree does not follow the id
+    template <typename W>
+    static void Permute(int n, std::vector<Edge<W>>& edges, const GeneratorOptions& options) {
+        std::vector<int> label(n + 1);
+        for (int v = 0; v <= n; ++v) {
+            label[v] = v;
+        }
+        Random random(options.seed, ~uint64_t{0});
+        for (int v = n; v > 1; --v) {
+            std::swap(label[v], label[1 + random.Below(static_cast<uint64_t>(v))]);
+        }
+        size_t chunks = (edges.size() + kChunkEdges - 1) / kChunkEdges;
+        ChunkedParser::ForEach(chunks, [&](size_t chunk) {
+            size_t last = std::min(edges.size(), (chunk + 1) * kChunkEdges);
+            for (size_t k = chunk * kChunkEdges; k < last; ++k) {
+                edges[k].u = label[edges[k].u];
+                edges[k].v = label[edges[k].v];
+            }
+        });
+    }
+
+    template <typename W>
+    static std::vector<Edge<W>> Concatenate(std::vector<std::vector<Edge<W>>>& parts) {
+        size_t total = 0;
+        for (const auto& part : parts) {
+            total += part.size();
+        }
+        std::vector<Edge<W>> edges;
+        edges.reserve(total);
+        for (auto& part : parts) {
+            edges.insert(edges.end(), part.begin(), part.end());
+            std::vector<Edge<W>>().swap(part);
+        }
+        return edges;
+    }
+
+    static GraphBase::Directedness DirectednessOf(const GeneratorOptions& options) {
+        return options.directed ? GraphBase::DIRECTED : GraphBase::UNDIRECTED;
+    }
+
+    static void CheckVertexCount(double n) {
+        if (n < 1 || n > INT_MAX - 2) {
+            throw std::invalid_argument("Invalid vertex count");
+        }
+    }
+
+public:
+    // R-MAT on 2^scale vertices: every edge descends `scale` levels of the
+    // adjacency matrix, picking a quadrant with probabilities a, b, c, 1-a-b-c.
+    // Vertex numbers are shuffled afterwards.
+    template <typename W = int>
+    static BasicGraph<W> Rmat(int scale, size_t edges, const GeneratorOptions& options = {},
+                              double a = 0.57, double b = 0.19, double c = 0.19) {
+        if (scale < 0 || scale > 30) {
+            throw std::invalid_argument("Invalid R-MAT scale");
+        }
+        // With b = c = 0 every edge would be a self-loop
+        if (a < 0 || b < 0 || c < 0 || a + b + c > 1 || b + c == 0) {
+            throw std::invalid_argument("Invalid R-MAT probabilities");
+        }
+        int n = 1 << scale;
+        if (n == 1 && edges > 0) {
+            throw std::invalid_argument("R-MAT needs at least two vertices for edges");
+        }
+        auto arcs = DrawPairs<W>(edges, options, [&](Random& random, int& u, int& v) {
+            u = v = 0;
+            for (int level = 0; level < scale; ++level) {
+                double r = random.Uniform();
+                int down = r >= a + b;
+                int right = (r >= a && r < a + b) || r >= a + b + c;
+                u = 2 * u + down;
+                v = 2 * v + right;
+            }
+            ++u;
+            ++v;
+        });
+        Permute<W>(n, arcs, options);
+        return BasicGraph<W>(n, std::move(arcs), options.storage, DirectednessOf(options));
+    }
+
+    // Erdős–Rényi G(n, m): m pairs drawn uniformly among distinct vertices
+    template <typename W = int>
+    static BasicGraph<W> ErdosRenyi(int n, size_t edges, const GeneratorOptions& options = {}) {
+        CheckVertexCount(n);
+        if (n == 1 && edges > 0) {
+            throw std::invalid_argument("G(n, m) needs at least two vertices for edges");
+        }
+        auto arcs = DrawPairs<W>(edges, options, [n](Random& random, int& u, int& v) {
+            u = 1 + static_cast<int>(random.Below(n));
+            v = 1 + static_cast<int>(random.Below(n));
+        });
+        return BasicGraph<W>(n, std::move(arcs), options.storage, DirectednessOf(options));
+    }
+
+    // rows x cols cells, cell (r, c) is vertex r * cols + c + 1. Each cell is a
+    // wall with probability `blocked`; open cells are joined to their open
+    // neighbours to the right and below. Walls stay as isolated vertices.
+    template <typename W = int>
+    static BasicGraph<W> Grid(int rows, int cols, double blocked = 0, const GeneratorOptions& options = {}) {
+        if (rows < 1 || cols < 1) {
+            throw std::invalid_argument("Invalid grid size");
+        }
+        CheckVertexCount(static_cast<double>(rows) * cols);
+        auto open = [&](int r, int c) {
+            uint64_t cell = static_cast<uint64_t>(r) * cols + c;
+            return static_cast<double>(Hash(options.seed, cell) >> 11) * 0x1.0p-53 >= blocked;
+        };
+        size_t rows_per_chunk = std::max<size_t>(1, kChunkEdges / cols);
+        size_t chunks = (rows + rows_per_chunk - 1) / rows_per_chunk;
+        std::vector<std::vector<Edge<W>>> parts(chunks);
+        ChunkedParser::ForEach(chunks, [&](size_t chunk) {
+            int first = static_cast<int>(chunk * rows_per_chunk);
+            int last = static_cast<int>(std::min<size_t>(rows, (chunk + 1) * rows_per_chunk));
+            auto& part = parts[chunk];
+            for (int r = first; r < last; ++r) {
+                for (int c = 0; c < cols; ++c) {
+                    if (!open(r, c)) {
+                        continue;
+                    }
+                    int u = r * cols + c + 1;
+                    auto link = [&](int v, uint64_t side) {
+                        auto weight = DrawWeight<W>(Hash(options.seed ^ side, static_cast<uint64_t>(u)), options);
+                        part.push_back({u, v, weight});
+                        part.push_back({v, u, weight});
+                    };
+                    if (c + 1 < cols && open(r, c + 1)) {
+                        link(u + 1, 1);
+                    }
+                    if (r + 1 < rows && open(r + 1, c)) {
+                        link(u + cols, 2);
+                    }
+                }
+            }
+        });
+        auto arcs = Concatenate<W>(parts);
+        return BasicGraph<W>(rows * cols, std::move(arcs), options.storage, GraphBase::UNDIRECTED);
+    }
+
+    // The cells of Grid(rows, cols, blocked, options) as a Map: open exactly
+    // where the grid graph has an unblocked vertex. As a Map, the size is not
+    // limited by the vertex count of a graph.
+    static Map Maze(int rows, int cols, double blocked = 0, const GeneratorOptions& options = {}) {
+        if (rows < 1 || cols < 1) {
+            throw std::invalid_argument("Invalid grid size");
+        }
+        Map map(rows, cols);
+        size_t rows_per_chunk = std::max<size_t>(1, kChunkEdges / cols);
+        size_t chunks = (rows + rows_per_chunk - 1) / rows_per_chunk;
+        ChunkedParser::ForEach(chunks, [&](size_t chunk) {
+            int first = static_cast<int>(chunk * rows_per_chunk);
+            int last = static_cast<int>(std::min<size_t>(rows, (chunk + 1) * rows_per_chunk));
+            for (int r = first; r < last; ++r) {
+                for (int c = 0; c < cols; ++c) {
+                    uint64_t cell = static_cast<uint64_t>(r) * cols + c;
+                    map.set(r, c, static_cast<double>(Hash(options.seed, cell) >> 11) * 0x1.0p-53 >= blocked);
+                }
+            }
+        });
+        return map;
+    }
+
+    // n points uniform in the unit square, joined when closer than `radius`.
+    // Points are binned into cells of side >= radius, so only neighbouring
+    // cells are compared.
+    template <typename W = int>
+    static BasicGraph<W> Geometric(int n, double radius, const GeneratorOptions& options = {}) {
+        CheckVertexCount(n);
+        if (!(radius > 0)) {
+            throw std::invalid_argument("Invalid radius");
+        }
+        std::vector<double> x(n + 1), y(n + 1);
+        for (int v = 1; v <= n; ++v) {
+            x[v] = static_cast<double>(Hash(options.seed, 2 * static_cast<uint64_t>(v)) >> 11) * 0x1.0p-53;
+            y[v] = static_cast<double>(Hash(options.seed, 2 * static_cast<uint64_t>(v) + 1) >> 11) * 0x1.0p-53;
+        }
+        // About one point per cell at most: finer cells only add empty ones
+        int side = static_cast<int>(std::min(std::floor(1 / radius), std::ceil(std::sqrt(static_cast<double>(n)))));
+        side = std::max(side, 1);
+        auto cell_of = [&](int v) {
+            int cx = std::min(side - 1, static_cast<int>(x[v] * side));
+            int cy = std::min(side - 1, static_cast<int>(y[v] * side));
+            return static_cast<size_t>(cy) * side + cx;
+        };
+        // Counting sort of the points by cell
+        size_t cells = static_cast<size_t>(side) * side;
+        std::vector<size_t> start(cells + 1, 0);
+        for (int v = 1; v <= n; ++v) {
+            ++start[cell_of(v) + 1];
+        }
+        for (size_t i = 1; i <= cells; ++i) {
+            start[i] += start[i - 1];
+        }
+        std::vector<int> points(n);
+        std::vector<size_t> next(start.begin(), start.end() - 1);
+        for (int v = 1; v <= n; ++v) {
+            points[next[cell_of(v)]++] = v;
+        }
+
+        double radius2 = radius * radius;
+        // A cell is compared with itself and the four neighbours after it, so every pair is seen once
+        static constexpr int kNext[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+        std::vector<std::vector<Edge<W>>> parts(side);
+        ChunkedParser::ForEach(static_cast<size_t>(side), [&](size_t cy) {
+            auto& part = parts[cy];
+            for (int cx = 0; cx < side; ++cx) {
+                size_t cell = cy * side + cx;
+                for (size_t i = start[cell]; i < start[cell + 1]; ++i) {
+                    int u = points[i];
+                    auto consider = [&](int v) {
+                        double dx = x[u] - x[v], dy = y[u] - y[v];
+                        if (dx * dx + dy * dy < radius2) {
+                            uint64_t key = static_cast<uint64_t>(std::min(u, v)) << 32 | static_cast<uint64_t>(std::max(u, v));
+                            auto weight = DrawWeight<W>(Hash(options.seed, key), options);
+                            part.push_back({u, v, weight});
+                            part.push_back({v, u, weight});
+                        }
+                    };
+                    for (size_t j = i + 1; j < start[cell + 1]; ++j) {
+                        consider(points[j]);
+                    }
+                    for (const auto& step : kNext) {
+                        int nx = cx + step[0], ny = static_cast<int>(cy) + step[1];
+                        if (nx < 0 || nx >= side || ny >= side) {
+                            continue;
+                        }
+                        size_t other = static_cast<size_t>(ny) * side + nx;
+                        for (size_t j = start[other]; j < start[other + 1]; ++j) {
+                            consider(points[j]);
+                        }
+                    }
+                }
+            }
+        });
+        auto arcs = Concatenate<W>(parts);
+        return BasicGraph<W>(n, std::move(arcs), options.storage, GraphBase::UNDIRECTED);
+    }
+
+    // Chung-Lu graph with expected degrees following a power law of the given
+    // exponent (> 2): vertex i has weight (i + i0)^(-1 / (exponent - 1)) and both
+    // ends of each of the n * average_degree / 2 edges are drawn by weight.
+    // Vertex numbers are shuffled afterwards.
+    template <typename W = int>
+    static BasicGraph<W> PowerLaw(int n, double exponent, double average_degree, const GeneratorOptions& options = {}) {
+        CheckVertexCount(n);
+        if (!(exponent > 2)) {
+            throw std::invalid_argument("Power-law exponent must be above 2");
+        }
+        if (n == 1 && average_degree > 0) {
+            throw std::invalid_argument("A power-law graph needs at least two vertices for edges");
+        }
+        // Expected degrees are proportional to (n / (i + i0))^power; the offset i0
+        // caps the largest one at about sqrt(n * average_degree)
+        double power = 1 / (exponent - 1);
+        double i0 = 0;
+        if (average_degree > 0) {
+            double ratio = std::sqrt(n * average_degree) * (exponent - 1) / (average_degree * (exponent - 2));
+            i0 = std::max(0.0, n * std::pow(ratio, -(exponent - 1)) - 1);
+        }
+        std::vector<double> cumulative(n + 1, 0);
+        for (int v = 1; v <= n; ++v) {
+            cumulative[v] = cumulative[v - 1] + std::pow(v + i0, -power);
+        }
+        double total = cumulative[n];
+        auto pick_one = [&](Random& random) {
+            double target = random.Uniform() * total;
+            auto it = std::upper_bound(cumulative.begin() + 1, cumulative.end(), target);
+            return static_cast<int>(std::min<std::ptrdiff_t>(it - cumulative.begin(), n));
+        };
+        auto edges = static_cast<size_t>(std::llround(n * std::max(0.0, average_degree) / (options.directed ? 1 : 2)));
+        auto arcs = DrawPairs<W>(edges, options, [&](Random& random, int& u, int& v) {
+            u = pick_one(random);
+            v = pick_one(random);
+        });
+        Permute<W>(n, arcs, options);
+        return BasicGraph<W>(n, std::move(arcs), options.storage, DirectednessOf(options));
+    }
+};
+
+#endif //UNTITLED2_GENERATORS_H
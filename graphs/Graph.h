@@ -6,110 +6,1465 @@
 #define UNTITLED2_GRAPH_H
 
 #include <vector>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <tuple>
 #include <stdexcept>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <charconv>
+#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "MappedFile.h"
+#include "Buffer.h"
+#include "ChunkedParser.h"
+#include "WeightTraits.h"
+#include "BitMatrix.h"
+#include "IdMap.h"
+#include "Reordering.h"
+#include "GraphStats.h"
+#include "Numa.h"
 
 struct NoneType {};
 constexpr NoneType None = NoneType();
 
-class Graph {
+// Options shared by every BasicGraph<W>, so Graph::MATRIX names the same
+// enumerator whatever the weight type is.
+class GraphBase {
+public:
+    enum FileType {
+        MATRIX,
+        EDGES_LIST,
+        ADJACENCY_LIST,
+        BINARY          // snapshot written by save_binary()
+    };
+
+    // DETECT derives directedness from the data; the other two skip the check
+    enum Directedness {
+        DETECT,
+        DIRECTED,
+        UNDIRECTED
+    };
+
+    // DENSE keeps an (n+1)^2 matrix next to the CSR arrays for O(1) weight lookups,
+    // CSR keeps only the compressed rows: O(V+E) memory, O(log deg) lookups.
+    // BITSET keeps one bit per matrix cell (rows of 64-bit words) for O(1) edge
+    // tests and word-parallel set operations; weights are looked up in the rows.
+    // EXTERNAL (BINARY snapshots only) copies the offsets into RAM and leaves the
+    // neighbour lists in the mapped file, paged in as traversals reach them;
+    // in_neighbors() and undirected_neighbors() build theirs in temporary files.
+    // AUTO picks DENSE, BITSET or CSR from the size and density of the loaded graph.
+    enum Storage {
+        AUTO,
+        DENSE,
+        CSR,
+        BITSET,
+        EXTERNAL
+    };
+
+    // INDEX_IDS: vertices are numbered 1..n in the file. EXTERNAL_IDS: arbitrary
+    // 64-bit ids (edge lists only), renumbered 1..n in order of first appearance.
+    enum VertexIds {
+        INDEX_IDS,
+        EXTERNAL_IDS
+    };
+
+    // Relabelings applied by reorder()
+    enum Ordering {
+        REVERSE_CUTHILL_MCKEE,
+        DEGREE_ORDER,   // highest degree first
+        BFS_ORDER
+    };
+
+    // Page placement for place(). Part w of vertex_ranges(workers.size()) belongs
+    // to worker w of the Numa::Workers passed along.
+    enum Placement {
+        FIRST_TOUCH,  // every worker writes its own part, which lands on the worker's node
+        INTERLEAVED,  // pages round-robin over all nodes, for kernels that read everywhere
+        PARTITIONED   // every part is put on its worker's node, whichever thread writes it
+    };
+
+    // Rows a traversal is about to read, for prefetch()
+    enum Rows {
+        OUT_ROWS,        // neighbors()
+        IN_ROWS,         // in_neighbors()
+        UNDIRECTED_ROWS  // undirected_neighbors()
+    };
+};
+
+// W is the edge weight type (uint8_t, int32_t, int64_t, float, double, ...) or
+// Unweighted, which stores no weights at all.
+template <typename W>
+class BasicGraph : public GraphBase {
+public:
+    using Traits = WeightTraits<W>;
+    using weight_type = typename Traits::value_type;
+    using distance_type = typename Traits::distance_type;
+
+    struct Neighbor {
+        int vertex;
+        weight_type weight;
+    };
+
+    // Non-owning view of one CSR row; valid while the graph is alive
+    class NeighborRange {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Neighbor;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Neighbor;
+
+            iterator(const int* id, const weight_type* weight) : id_(id), weight_(weight) {}
+
+            Neighbor operator*() const {
+                if constexpr (Traits::kStored) {
+                    return {*id_, *weight_};
+                } else {
+                    return {*id_, 1};
+                }
+            }
+            iterator& operator++() {
+                ++id_;
+                if constexpr (Traits::kStored) {
+                    ++weight_;
+                }
+                return *this;
+            }
+            iterator operator++(int) {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==(const iterator& other) const { return id_ == other.id_; }
+            bool operator!=(const iterator& other) const { return id_ != other.id_; }
+
+        private:
+            const int* id_;
+            const weight_type* weight_;
+        };
+
+        NeighborRange(const int* ids, const weight_type* weights, size_t count)
+                : ids_(ids), weights_(weights), count_(count) {}
+
+        [[nodiscard]] iterator begin() const { return {ids_, weights_}; }
+        [[nodiscard]] iterator end() const { return {ids_ + count_, Traits::kStored ? weights_ + count_ : nullptr}; }
+        [[nodiscard]] size_t size() const { return count_; }
+        [[nodiscard]] bool empty() const { return count_ == 0; }
+        // The neighbour ids, contiguous in memory
+        [[nodiscard]] const int* data() const { return ids_; }
+
+    private:
+        const int* ids_;
+        const weight_type* weights_;
+        size_t count_;
+    };
+
+    // Read-only row-major view of the weight matrix: cell (u, v) is
+    // data()[u * stride() + v]. Valid while the graph is alive and unchanged.
+    class MatrixView {
+    public:
+        MatrixView(const weight_type* data, size_t stride) : data_(data), stride_(stride) {}
+
+        [[nodiscard]] weight_type operator()(int u, int v) const {
+            return data_[static_cast<size_t>(u) * stride_ + v];
+        }
+        [[nodiscard]] const weight_type* row(int u) const { return data_ + static_cast<size_t>(u) * stride_; }
+        [[nodiscard]] const weight_type* data() const { return data_; }
+        [[nodiscard]] size_t stride() const { return stride_; }
+        [[nodiscard]] bool empty() const { return data_ == nullptr; }
+
+    private:
+        const weight_type* data_;
+        size_t stride_;
+    };
+
+    struct Edge {
+        int u;
+        int v;
+        weight_type weight;
+    };
+
+    // Returned by edge_id() and reverse_edge() when there is no such arc
+    static constexpr size_t kNoEdge = SIZE_MAX;
+
+    // Ids of one row's arcs: a run of consecutive integers
+    class EdgeIdRange {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = size_t;
+
+            explicit iterator(size_t id) : id_(id) {}
+
+            size_t operator*() const { return id_; }
+            iterator& operator++() {
+                ++id_;
+                return *this;
+            }
+            iterator operator++(int) {
+                iterator old = *this;
+                ++id_;
+                return old;
+            }
+            bool operator==(const iterator& other) const { return id_ == other.id_; }
+            bool operator!=(const iterator& other) const { return id_ != other.id_; }
+
+        private:
+            size_t id_;
+        };
+
+        EdgeIdRange(size_t first, size_t last) : first_(first), last_(last) {}
+
+        [[nodiscard]] iterator begin() const { return iterator(first_); }
+        [[nodiscard]] iterator end() const { return iterator(last_); }
+        [[nodiscard]] size_t size() const { return last_ - first_; }
+        [[nodiscard]] bool empty() const { return first_ == last_; }
+
+    private:
+        size_t first_;
+        size_t last_;
+    };
+
+    // Walks the rows in place, yielding what list_of_edges() would return
+    class EdgeRange {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Edge;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Edge;
+
+            iterator(const BasicGraph* graph, int u) : graph_(graph), u_(u) {
+                if (u_ <= graph_->size_) {
+                    arc_ = graph_->offsets_[u_];
+                    end_ = graph_->RowEnd(u_);
+                    Settle();
+                }
+            }
+
+            Edge operator*() const {
+                return {u_, graph_->neighbors_[arc_], graph_->WeightAt(arc_)};
+            }
+            iterator& operator++() {
+                ++arc_;
+                Settle();
+                return *this;
+            }
+            iterator operator++(int) {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==(const iterator& other) const { return u_ == other.u_ && arc_ == other.arc_; }
+            bool operator!=(const iterator& other) const { return !(*this == other); }
+
+        private:
+            const BasicGraph* graph_;
+            int u_;
+            size_t arc_ = 0;
+            size_t end_ = 0;
+
+            // Moves forward to the next arc to yield; an undirected edge is
+            // yielded once, from its smaller end
+            void Settle() {
+                for (;;) {
+                    for (; arc_ < end_; ++arc_) {
+                        if (graph_->is_directed_ || u_ <= graph_->neighbors_[arc_]) {
+                            return;
+                        }
+                    }
+                    if (++u_ > graph_->size_) {
+                        arc_ = end_ = 0;
+                        return;
+                    }
+                    arc_ = graph_->offsets_[u_];
+                    end_ = graph_->RowEnd(u_);
+                }
+            }
+        };
+
+        explicit EdgeRange(const BasicGraph* graph) : graph_(graph) {}
+
+        [[nodiscard]] iterator begin() const { return {graph_, 1}; }
+        [[nodiscard]] iterator end() const { return {graph_, graph_->size_ + 1}; }
+
+    private:
+        const BasicGraph* graph_;
+    };
+
 private:
+    template <typename Id>
+    struct BasicArc {
+        Id u, v;
+        weight_type weight;
+    };
+    using Arc = BasicArc<int>;
+
+    // On-disk layout of a BINARY snapshot. Every section starts on a page boundary,
+    // so the loader can hand out views of the mapping instead of copying.
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint64_t size;
+        uint64_t arc_count;
+        uint64_t offsets_pos;
+        uint64_t neighbors_pos;
+        uint64_t weights_pos;
+        uint64_t asymmetric_arcs;
+        uint64_t self_loops;
+        uint64_t ids_pos;
+        uint32_t offset_bytes;
+        uint32_t weight_bytes;
+        uint32_t weight_kind;
+    };
+
+    static constexpr char kSnapshotMagic[8] = {'G', 'R', 'A', 'P', 'H', 'B', 'I', 'N'};
+    static constexpr uint32_t kSnapshotVersion = 5;
+    static constexpr uint32_t kSnapshotDirected = 1;
+    static constexpr uint32_t kSnapshotExternalIds = 2;
+    static constexpr uint32_t kSnapshotDetected = 4;
+    static constexpr uint64_t kPageSize = 4096;
+    // AUTO: matrices up to kSmallMatrixBytes are always worth it, none above kMaxMatrixBytes
+    static constexpr double kSmallMatrixBytes = 1 << 20;
+    static constexpr double kMaxMatrixBytes = 1 << 28;
+    // BuildFromArcs: arcs per part below which another thread does not pay, and
+    // the most parts, so that a part number fits the byte kept per slot
+    static constexpr size_t kMinBuildArcs = 1 << 16;
+    static constexpr size_t kMaxBuildParts = 255;
+
     int size_{};
     bool is_directed_;
-    std::vector<std::vector<int>> adjacency_matrix_;
+    // False when directedness was declared at load; then it never changes
+    bool detect_directedness_ = true;
+    // Arcs (u, v, w) without a matching (v, u, w); is_directed_ unless declared
+    size_t asymmetric_arcs_ = 0;
+    size_t arc_count_ = 0;
+    size_t self_loops_ = 0;
+    Storage storage_;
+    // Neighbours of u are neighbors_[offsets_[u] .. RowEnd(u)), sorted by id.
+    // The buffers either own their data or view a mapped BINARY snapshot.
+    Buffer<size_t> offsets_;
+    Buffer<int> neighbors_;
+    Buffer<weight_type> weights_;  // empty for Unweighted
+    // Row-major (size_ + 1) x (size_ + 1), only for DENSE storage of weighted graphs.
+    // A Buffer so that place() can move it to placed pages.
+    Buffer<weight_type> adjacency_matrix_;
+    // Same shape, one bit per cell: BITSET storage, and DENSE for Unweighted
+    BitMatrix adjacency_bits_;
+    // Set when loaded with EXTERNAL_IDS or after reorder(). Copies share it;
+    // add_vertex() copies it before inserting if it is shared.
+    std::shared_ptr<IdMap> ids_;
+    // Empty until the first mutation. Afterwards row u ends at ends_[u] and can grow
+    // in place up to limits_[u]; a full row moves to the back of neighbors_ with
+    // twice the room, leaving garbage_ dead slots until the next Compact().
+    std::vector<size_t> ends_;
+    std::vector<size_t> limits_;
+    size_t garbage_ = 0;
+    // Kept from the load; copies and mutations leave it as it was
+    LoadTimes load_times_;
 
-    void LoadMatrix(const std::string& path) {
-        std::ifstream file(path);
-        if (!file.is_open()) {
-            throw std::runtime_error("Cannot open file");
+    // Plain CSR rows derived from the arcs: the transpose, or the union of each
+    // row with its transpose. With EXTERNAL storage only the offsets are in RAM;
+    // the rows are written to a temporary file and paged like the snapshot.
+    struct DerivedRows {
+        std::vector<size_t> offsets;
+        Buffer<int> neighbors;
+        Buffer<weight_type> weights;  // empty for Unweighted
+
+        [[nodiscard]] NeighborRange Row(int v) const {
+            const weight_type* row_weights = Traits::kStored ? weights.data() + offsets[v] : nullptr;
+            return {neighbors.data() + offsets[v], row_weights, offsets[v + 1] - offsets[v]};
+        }
+    };
+
+    // A value that const methods compute on first use. Concurrent first uses may
+    // each compute it; one result is published and the others are discarded, so
+    // later reads are a single atomic load. Copies share the value.
+    template <typename T>
+    class Lazy {
+    public:
+        Lazy() = default;
+
+        Lazy(const Lazy& other) : owner_(std::atomic_load(&other.owner_)), value_(owner_.get()) {}
+
+        Lazy& operator=(const Lazy& other) {
+            if (this != &other) {
+                owner_ = std::atomic_load(&other.owner_);
+                value_.store(owner_.get());
+            }
+            return *this;
+        }
+
+        template <typename Make>
+        const T& Get(Make make) const {
+            const T* value = value_.load(std::memory_order_acquire);
+            if (value == nullptr) {
+                auto built = std::make_shared<const T>(make());
+                if (value_.compare_exchange_strong(value, built.get(), std::memory_order_acq_rel)) {
+                    std::atomic_store(&owner_, built);
+                    value = built.get();
+                }
+            }
+            return *value;
+        }
+
+        // The value if it has been built, nullptr otherwise
+        const T* Peek() const {
+            return value_.load(std::memory_order_acquire);
+        }
+
+        // Not safe against a concurrent Get(); only mutations call it
+        void Reset() {
+            owner_.reset();
+            value_.store(nullptr);
+        }
+
+    private:
+        mutable std::shared_ptr<const T> owner_;
+        mutable std::atomic<const T*> value_{nullptr};
+    };
+
+    // Built on first request and dropped by every change
+    Lazy<DerivedRows> in_rows_;
+    Lazy<DerivedRows> undirected_rows_;
+    // reverse_edges_[id] is the id of the opposite arc, kNoEdge if there is none
+    Lazy<std::vector<size_t>> reverse_edges_;
+
+    void CheckVertex(int v) const {
+        if (v < 1 || v > size_) {
+            throw std::out_of_range("Vertex index out of range");
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    // Seconds since `start`, which is moved to now
+    static double Lap(Clock::time_point& start) {
+        Clock::time_point now = Clock::now();
+        double seconds = std::chrono::duration<double>(now - start).count();
+        start = now;
+        return seconds;
+    }
+
+    [[nodiscard]] size_t RowEnd(int u) const {
+        return ends_.empty() ? offsets_[u + 1] : ends_[u];
+    }
+
+    [[nodiscard]] weight_type WeightAt(size_t arc) const {
+        if constexpr (Traits::kStored) {
+            return weights_[arc];
+        } else {
+            return 1;
+        }
+    }
+
+    // Index of arc (u, v) in neighbors_, or neighbors_.size() if there is none
+    [[nodiscard]] size_t FindArc(int u, int v) const {
+        auto first = neighbors_.begin() + offsets_[u];
+        auto last = neighbors_.begin() + RowEnd(u);
+        auto it = std::lower_bound(first, last, v);
+        if (it == last || *it != v) {
+            return neighbors_.size();
+        }
+        return it - neighbors_.begin();
+    }
+
+    // neighbors_[i], which must be a vertex: rows mapped from a snapshot are only
+    // trusted once checked here
+    [[nodiscard]] int CheckedNeighbor(size_t i) const {
+        int v = neighbors_[i];
+        if (v < 1 || v > size_) {
+            throw std::runtime_error("Corrupted snapshot");
+        }
+        return v;
+    }
+
+    // Arcs [begin, end) of a row, from whichever arrays are views of a file
+    static void PrefetchRow(const Buffer<int>& neighbors, const Buffer<weight_type>& weights, size_t begin, size_t end) {
+        neighbors.prefetch(begin, end - begin);
+        if constexpr (Traits::kStored) {
+            weights.prefetch(begin, end - begin);
+        }
+    }
+
+    // Builds the CSR rows from arcs in file order. A repeated (u, v) keeps the
+    // last weight and a zero weight means "no edge", as with the matrix.
+    // A is Arc or Edge: anything with u, v and weight. Parts of the arcs count
+    // their rows and then scatter straight into the final arrays, each on its own
+    // thread; the arcs are freed right after, so they never coexist with a sorted
+    // copy of themselves. Slots of one part keep their file order within a row,
+    // and with several parts a byte per slot records the part, which is enough to
+    // order repeated arcs as in the file. Rows are then sorted, again in parallel.
+    // With check_vertices every endpoint is checked against 1..size_ first.
+    template <typename A>
+    void BuildFromArcs(std::vector<A>& arcs, bool check_vertices = false) {
+        size_t total = arcs.size();
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t parts = std::clamp<size_t>(std::min(threads, total / kMinBuildArcs), 1, kMaxBuildParts);
+        auto part_begin = [total, parts](size_t p) { return total * p / parts; };
+
+        // Slot j of row u; a locked add would keep the misses of one thread from
+        // overlapping, so a single part bumps the counter with a plain store
+        std::vector<std::atomic<size_t>> next(size_ + 2);
+        auto take = [&next, parts](int u) {
+            if (parts == 1) {
+                size_t j = next[u].load(std::memory_order_relaxed);
+                next[u].store(j + 1, std::memory_order_relaxed);
+                return j;
+            }
+            return next[u].fetch_add(1, std::memory_order_relaxed);
+        };
+        ChunkedParser::ForEach(parts, [&](size_t p) {
+            for (size_t i = part_begin(p); i < part_begin(p + 1); ++i) {
+                if (check_vertices) {
+                    CheckVertex(arcs[i].u);
+                    CheckVertex(arcs[i].v);
+                }
+                take(arcs[i].u);
+            }
+        });
+        std::vector<size_t> offsets(size_ + 2, 0);
+        for (int u = 0; u <= size_; ++u) {
+            offsets[u + 1] = offsets[u] + next[u].load(std::memory_order_relaxed);
+            next[u].store(offsets[u], std::memory_order_relaxed);
+        }
+
+        // A zero weight is kept as a negative target until repeats are resolved
+        std::vector<int> neighbors(total);
+        std::vector<weight_type> weights(Traits::kStored ? total : 0);
+        std::vector<uint8_t> part_of(parts > 1 ? total : 0);
+        ChunkedParser::ForEach(parts, [&](size_t p) {
+            for (size_t i = part_begin(p); i < part_begin(p + 1); ++i) {
+                const A& arc = arcs[i];
+                size_t j = take(arc.u);
+                neighbors[j] = arc.weight != 0 ? arc.v : -arc.v;
+                if constexpr (Traits::kStored) {
+                    weights[j] = arc.weight;
+                }
+                if (parts > 1) {
+                    part_of[j] = static_cast<uint8_t>(p);
+                }
+            }
+        });
+        arcs.clear();
+        arcs.shrink_to_fit();
+        std::vector<std::atomic<size_t>>().swap(next);
+
+        // Row ranges of about equal arc counts; rows that are already strictly
+        // increasing with no zero weight are left as they are
+        size_t ranges = parts * 4;
+        auto range_begin = [&](size_t r) {
+            if (r == ranges) {
+                return size_ + 1;
+            }
+            auto it = std::lower_bound(offsets.begin() + 1, offsets.begin() + size_ + 1, total * r / ranges);
+            return static_cast<int>(it - offsets.begin());
+        };
+        std::vector<size_t> kept(size_ + 1, 0);
+        ChunkedParser::ForEach(ranges, [&](size_t r) {
+            // Position in the row breaks ties within a part, so std::sort keeps
+            // file order without the buffer of std::stable_sort
+            struct Slot {
+                int v;
+                uint8_t part;
+                size_t position;
+                weight_type weight;
+            };
+            std::vector<Slot> row;
+            for (int u = range_begin(r); u < range_begin(r + 1); ++u) {
+                size_t begin = offsets[u], end = offsets[u + 1];
+                size_t i = begin;
+                while (i < end && neighbors[i] > 0 && (i == begin || neighbors[i - 1] < neighbors[i])) {
+                    ++i;
+                }
+                if (i == end) {
+                    kept[u] = end - begin;
+                    continue;
+                }
+                row.clear();
+                for (i = begin; i < end; ++i) {
+                    row.push_back({neighbors[i], parts > 1 ? part_of[i] : uint8_t{0}, i,
+                                   Traits::kStored ? weights[i] : 1});
+                }
+                std::sort(row.begin(), row.end(), [](const Slot& a, const Slot& b) {
+                    int av = std::abs(a.v), bv = std::abs(b.v);
+                    if (av != bv) {
+                        return av < bv;
+                    }
+                    return a.part != b.part ? a.part < b.part : a.position < b.position;
+                });
+                size_t out = begin;
+                for (size_t k = 0; k < row.size(); ++k) {
+                    if (k + 1 < row.size() && std::abs(row[k + 1].v) == std::abs(row[k].v)) {
+                        continue;
+                    }
+                    if (row[k].v > 0) {
+                        neighbors[out] = row[k].v;
+                        if constexpr (Traits::kStored) {
+                            weights[out] = row[k].weight;
+                        }
+                        ++out;
+                    }
+                }
+                kept[u] = out - begin;
+            }
+        });
+        std::vector<uint8_t>().swap(part_of);
+
+        // Close up the rows that lost repeats or zero weights
+        size_t written = 0;
+        for (int u = 0; u <= size_; ++u) {
+            size_t begin = offsets[u];
+            offsets[u] = written;
+            if (begin != written) {
+                std::copy(neighbors.begin() + begin, neighbors.begin() + begin + kept[u], neighbors.begin() + written);
+                if constexpr (Traits::kStored) {
+                    std::copy(weights.begin() + begin, weights.begin() + begin + kept[u], weights.begin() + written);
+                }
+            }
+            written += kept[u];
+        }
+        offsets[size_ + 1] = written;
+        if (written != total) {
+            neighbors.resize(written);
+            neighbors.shrink_to_fit();
+            weights.resize(Traits::kStored ? written : 0);
+            weights.shrink_to_fit();
+        }
+        SetCsr(std::move(offsets), std::move(neighbors), std::move(weights));
+    }
+
+    void SetCsr(std::vector<size_t> offsets, std::vector<int> neighbors, std::vector<weight_type> weights) {
+        offsets_ = std::move(offsets);
+        neighbors_ = std::move(neighbors);
+        weights_ = std::move(weights);
+    }
+
+    // The weight matrix while it is small or at most 4x the size of the rows, the bit
+    // matrix while it is no larger than the rows, the rows alone otherwise
+    [[nodiscard]] Storage ChooseStorage() const {
+        double cells = (size_ + 1.0) * (size_ + 1.0);
+        double row_bytes = arc_count_ * (sizeof(int) + (Traits::kStored ? sizeof(weight_type) : 0)) +
+                           (size_ + 2.0) * sizeof(size_t);
+        double matrix_bytes = Traits::kStored ? cells * sizeof(weight_type) : cells / 8;
+        double bit_bytes = cells / 8;
+        if (matrix_bytes <= kMaxMatrixBytes && (matrix_bytes <= kSmallMatrixBytes || matrix_bytes <= 4 * row_bytes)) {
+            return DENSE;
+        }
+        if (bit_bytes <= kMaxMatrixBytes && bit_bytes <= row_bytes) {
+            return BITSET;
+        }
+        return CSR;
+    }
+
+    // Builds the matrix that storage_ keeps next to the rows, if any
+    void BuildMatrix() {
+        adjacency_matrix_ = Buffer<weight_type>();
+        adjacency_bits_ = BitMatrix();
+        if (storage_ == CSR || storage_ == EXTERNAL) {
+            return;
+        }
+        size_t stride = size_ + 1;
+        bool weighted = storage_ == DENSE && Traits::kStored;
+        std::vector<weight_type> matrix;
+        if (weighted) {
+            matrix.assign(stride * stride, 0);
+        } else {
+            adjacency_bits_ = BitMatrix(stride, stride);
         }
-        file >> size_;
-        adjacency_matrix_.resize(size_ + 1, std::vector<int>(size_ + 1, 0));
         for (int u = 1; u <= size_; ++u) {
-            for (int v = 1; v <= size_; ++v) {
-                file >> adjacency_matrix_[u][v];
+            for (size_t i = offsets_[u]; i < RowEnd(u); ++i) {
+                int v = CheckedNeighbor(i);
+                if (weighted) {
+                    matrix[u * stride + v] = WeightAt(i);
+                } else {
+                    adjacency_bits_.set(u, v);
+                }
             }
         }
-        file.close();
+        adjacency_matrix_ = std::move(matrix);
     }
 
-    void LoadEdgesList(const std::string& path) {
-        std::ifstream file(path);
-        if (!file.is_open()) {
-            throw std::runtime_error("Cannot open file");
+    // Untouched anonymous memory for `count` elements with the page policy of
+    // `placement`; worker w will write elements first[w] .. first[w + 1] - 1
+    template <typename T>
+    static std::shared_ptr<MappedFile> Reserve(size_t count, const std::vector<size_t>& first,
+                                               Placement placement, const Numa::Workers& workers) {
+        auto memory = std::make_shared<MappedFile>(MappedFile::Anonymous(count * sizeof(T)));
+        char* base = memory->writable_data();
+        if (count == 0) {
+            return memory;
         }
-        file >> size_;
-        adjacency_matrix_.resize(size_ + 1, std::vector<int>(size_ + 1, 0));
-        std::string line;
-        std::getline(file, line); // Consume the remaining part of the first line
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            int u, v, weight = 1;
-            iss >> u >> v;
-            if (!(iss >> weight)) {
-                weight = 1;
+        if (placement == INTERLEAVED) {
+            Numa::Interleave(base, memory->size());
+        } else if (placement == PARTITIONED) {
+            // A page shared by two parts goes to the later one
+            for (int w = 0; w < workers.size(); ++w) {
+                Numa::Prefer(base + first[w] * sizeof(T), (first[w + 1] - first[w]) * sizeof(T), workers.node(w));
             }
-            adjacency_matrix_[u][v] = weight;
         }
-        file.close();
+        return memory;
+    }
+
+    // Worker w's share of a placed copy of `source`
+    template <typename T>
+    static void CopyPart(const Buffer<T>& source, MappedFile& target, const std::vector<size_t>& first, int w) {
+        T* out = reinterpret_cast<T*>(target.writable_data());
+        std::copy(source.begin() + first[w], source.begin() + first[w + 1], out + first[w]);
+    }
+
+    // Reads the vertex count at the start of the file, returns the position after it
+    const char* ReadSize(const char* p, const char* end) {
+        p = ChunkedParser::SkipWhitespace(p, end);
+        p = ChunkedParser::ParseNumber(p, end, size_);
+        if (p == nullptr || size_ < 0) {
+            throw std::runtime_error("Invalid vertex count");
+        }
+        return p;
+    }
+
+    // Concatenates per-chunk arcs in file order
+    template <typename Id>
+    static std::vector<BasicArc<Id>> Concatenate(std::vector<std::vector<BasicArc<Id>>>& parts) {
+        size_t total = 0;
+        for (const auto& part : parts) {
+            total += part.size();
+        }
+        std::vector<BasicArc<Id>> arcs;
+        arcs.reserve(total);
+        for (auto& part : parts) {
+            arcs.insert(arcs.end(), part.begin(), part.end());
+            std::vector<BasicArc<Id>>().swap(part);
+        }
+        return arcs;
+    }
+
+    void LoadMatrix(const std::string& path) {
+        Clock::time_point start = Clock::now();
+        MappedFile file(path);
+        const char* end = file.data() + file.size();
+        load_times_.read += Lap(start);
+        const char* p = ReadSize(file.data(), end);
+
+        // Every chunk records its non-zero cells by token index within the chunk
+        struct Cells {
+            size_t tokens = 0;
+            std::vector<std::pair<size_t, weight_type>> non_zero;
+        };
+        auto chunks = ChunkedParser::Split(p, end);
+        std::vector<Cells> parts(chunks.size());
+        ChunkedParser::Run(chunks, [&](size_t i, ChunkedParser::Chunk chunk) {
+            Cells& cells = parts[i];
+            const char* q = ChunkedParser::SkipWhitespace(chunk.begin, chunk.end);
+            while (q < chunk.end) {
+                typename Traits::parse_type parsed;
+                q = ChunkedParser::ParseNumber(q, chunk.end, parsed);
+                if (q == nullptr) {
+                    throw std::runtime_error("Invalid matrix entry");
+                }
+                weight_type weight = Traits::from_parsed(parsed);
+                if (weight != 0) {
+                    cells.non_zero.emplace_back(cells.tokens, weight);
+                }
+                ++cells.tokens;
+                q = ChunkedParser::SkipWhitespace(q, chunk.end);
+            }
+        });
+        load_times_.parse += Lap(start);
+
+        size_t n = size_;
+        std::vector<size_t> offsets(size_ + 2, 0);
+        std::vector<int> neighbors;
+        std::vector<weight_type> weights;
+        size_t base = 0;
+        for (const auto& cells : parts) {
+            for (auto [token, weight] : cells.non_zero) {
+                size_t cell = base + token;
+                if (cell >= n * n) {
+                    break;
+                }
+                ++offsets[cell / n + 2];
+                neighbors.push_back(static_cast<int>(cell % n) + 1);
+                if constexpr (Traits::kStored) {
+                    weights.push_back(weight);
+                }
+            }
+            base += cells.tokens;
+        }
+        for (int u = 1; u <= size_ + 1; ++u) {
+            offsets[u] += offsets[u - 1];
+        }
+        SetCsr(std::move(offsets), std::move(neighbors), std::move(weights));
+        load_times_.build += Lap(start);
+    }
+
+    // Parses "u v [w]" lines; Id is int for vertex numbers, int64_t for external ids
+    template <typename Id>
+    std::vector<std::vector<BasicArc<Id>>> ParseEdges(const char* p, const char* end) const {
+        auto chunks = ChunkedParser::Split(p, end);
+        std::vector<std::vector<BasicArc<Id>>> parts(chunks.size());
+        ChunkedParser::Run(chunks, [&](size_t i, ChunkedParser::Chunk chunk) {
+            for (const char* line = chunk.begin; line < chunk.end; line = ChunkedParser::NextLine(line, chunk.end)) {
+                Id u, v;
+                typename Traits::parse_type weight = 1;
+                const char* q = ChunkedParser::SkipBlanks(line, chunk.end);
+                q = ChunkedParser::ParseNumber(q, chunk.end, u);
+                if (q == nullptr) {
+                    continue;
+                }
+                q = ChunkedParser::ParseNumber(ChunkedParser::SkipBlanks(q, chunk.end), chunk.end, v);
+                if (q == nullptr) {
+                    continue;
+                }
+                q = ChunkedParser::SkipBlanks(q, chunk.end);
+                if (q < chunk.end && *q != '\n' &&
+                    ChunkedParser::ParseNumber(q, chunk.end, weight) == nullptr) {
+                    throw std::runtime_error("Invalid edge weight");
+                }
+                if constexpr (std::is_same_v<Id, int>) {
+                    CheckVertex(u);
+                    CheckVertex(v);
+                }
+                parts[i].push_back({u, v, Traits::from_parsed(weight)});
+            }
+        });
+        return parts;
+    }
+
+    void LoadEdgesList(const std::string& path, VertexIds ids) {
+        Clock::time_point start = Clock::now();
+        MappedFile file(path);
+        const char* end = file.data() + file.size();
+        load_times_.read += Lap(start);
+        const char* p = ChunkedParser::NextLine(ReadSize(file.data(), end), end);
+
+        if (ids == INDEX_IDS) {
+            auto parts = ParseEdges<int>(p, end);
+            auto arcs = Concatenate(parts);
+            load_times_.parse += Lap(start);
+            BuildFromArcs(arcs);
+            load_times_.build += Lap(start);
+            return;
+        }
+
+        // The vertex count in the header only sizes the id table here. Ids are
+        // numbered sequentially so the result does not depend on the thread count.
+        auto parts = ParseEdges<int64_t>(p, end);
+        load_times_.parse += Lap(start);
+        size_t total = 0;
+        for (const auto& part : parts) {
+            total += part.size();
+        }
+        auto map = std::make_shared<IdMap>(static_cast<size_t>(size_));
+        std::vector<Arc> arcs;
+        arcs.reserve(total);
+        // Edge lists are usually grouped by source, so the source lookup is cached
+        int64_t last_id = 0;
+        int u = 0;
+        for (auto& part : parts) {
+            for (const auto& arc : part) {
+                if (u == 0 || arc.u != last_id) {
+                    last_id = arc.u;
+                    u = map->Insert(arc.u);
+                }
+                arcs.push_back({u, map->Insert(arc.v), arc.weight});
+            }
+            std::vector<BasicArc<int64_t>>().swap(part);
+        }
+        if (map->size() > INT_MAX - 2) {
+            throw std::runtime_error("Too many vertices");
+        }
+        size_ = map->size();
+        ids_ = std::move(map);
+        BuildFromArcs(arcs);
+        load_times_.build += Lap(start);
     }
 
     void LoadAdjacencyList(const std::string& path) {
-        std::ifstream file(path);
-        if (!file.is_open()) {
-            throw std::runtime_error("Cannot open file");
+        Clock::time_point start = Clock::now();
+        MappedFile file(path);
+        const char* end = file.data() + file.size();
+        load_times_.read += Lap(start);
+        const char* p = ChunkedParser::NextLine(ReadSize(file.data(), end), end);
+
+        // Line k of the body lists the neighbours of vertex k. Chunks number their
+        // lines locally, the global row is fixed up once all line counts are known.
+        auto chunks = ChunkedParser::Split(p, end);
+        std::vector<std::vector<Arc>> parts(chunks.size());
+        std::vector<int> lines(chunks.size(), 0);
+        ChunkedParser::Run(chunks, [&](size_t i, ChunkedParser::Chunk chunk) {
+            for (const char* line = chunk.begin; line < chunk.end; line = ChunkedParser::NextLine(line, chunk.end)) {
+                int row = ++lines[i];
+                const char* q = ChunkedParser::SkipBlanks(line, chunk.end);
+                while (q < chunk.end && *q != '\n') {
+                    int v;
+                    typename Traits::parse_type weight = 1;
+                    q = ChunkedParser::ParseNumber(q, chunk.end, v);
+                    if (q != nullptr && q < chunk.end && *q == ':') {
+                        q = ChunkedParser::ParseNumber(q + 1, chunk.end, weight);
+                    }
+                    if (q == nullptr) {
+                        throw std::runtime_error("Invalid adjacency list entry");
+                    }
+                    CheckVertex(v);
+                    parts[i].push_back({row, v, Traits::from_parsed(weight)});
+                    q = ChunkedParser::SkipBlanks(q, chunk.end);
+                }
+            }
+        });
+        int base = 0;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            auto& part = parts[i];
+            for (auto& arc : part) {
+                arc.u += base;
+            }
+            part.erase(std::remove_if(part.begin(), part.end(), [this](const Arc& arc) { return arc.u > size_; }),
+                       part.end());
+            base += lines[i];
+        }
+        auto arcs = Concatenate(parts);
+        load_times_.parse += Lap(start);
+        BuildFromArcs(arcs);
+        load_times_.build += Lap(start);
+    }
+
+    void LoadBinary(const std::string& path) {
+        Clock::time_point start = Clock::now();
+        auto mapping = std::make_shared<const MappedFile>(path);
+        SnapshotHeader header{};
+        if (mapping->size() < sizeof(header)) {
+            throw std::runtime_error("Invalid snapshot");
+        }
+        std::memcpy(&header, mapping->data(), sizeof(header));
+        if (std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+            throw std::runtime_error("Invalid snapshot");
+        }
+        if (header.version != kSnapshotVersion || header.offset_bytes != sizeof(size_t) ||
+            header.size > static_cast<uint64_t>(INT_MAX - 2)) {
+            throw std::runtime_error("Unsupported snapshot");
+        }
+        if (header.weight_kind != Traits::kKind) {
+            throw std::runtime_error("Snapshot weight type does not match the graph");
+        }
+        size_ = static_cast<int>(header.size);
+        offsets_ = Buffer<size_t>::View(mapping, header.offsets_pos, size_ + 2);
+        neighbors_ = Buffer<int>::View(mapping, header.neighbors_pos, header.arc_count);
+        if constexpr (Traits::kStored) {
+            weights_ = Buffer<weight_type>::View(mapping, header.weights_pos, header.arc_count);
+        }
+        // Rows must nest inside the arc arrays; ids are checked where they index
+        // memory, so mapped rows are not read in here
+        if (offsets_[size_ + 1] != header.arc_count) {
+            throw std::runtime_error("Corrupted snapshot");
+        }
+        for (int u = 0; u <= size_; ++u) {
+            if (offsets_[u] > offsets_[u + 1]) {
+                throw std::runtime_error("Corrupted snapshot");
+            }
+        }
+        if (storage_ == EXTERNAL) {
+            // Rows are mostly visited in vertex order, so let the kernel read ahead
+            offsets_ = std::vector<size_t>(offsets_.begin(), offsets_.end());
+            MappedFile::Advise(neighbors_.data(), neighbors_.size() * sizeof(int), MappedFile::SEQUENTIAL);
+            MappedFile::Advise(weights_.data(), weights_.size() * sizeof(weight_type), MappedFile::SEQUENTIAL);
+        }
+        is_directed_ = (header.flags & kSnapshotDirected) != 0;
+        detect_directedness_ = (header.flags & kSnapshotDetected) != 0;
+        asymmetric_arcs_ = header.asymmetric_arcs;
+        self_loops_ = header.self_loops;
+        load_times_.read += Lap(start);
+        if (header.flags & kSnapshotExternalIds) {
+            auto externals = Buffer<int64_t>::View(mapping, header.ids_pos, size_ + 1);
+            auto map = std::make_shared<IdMap>(static_cast<size_t>(size_));
+            for (int v = 1; v <= size_; ++v) {
+                if (map->Insert(externals[v]) != v) {
+                    throw std::runtime_error("Corrupted snapshot");
+                }
+            }
+            ids_ = std::move(map);
+        }
+        load_times_.build += Lap(start);
+    }
+
+    static uint64_t AlignToPage(uint64_t pos) {
+        return (pos + kPageSize - 1) / kPageSize * kPageSize;
+    }
+
+    // Writes bytes at `pos`, zero-filling the gap from the current end of the file
+    static void WriteAt(std::ofstream& file, uint64_t& written, uint64_t pos, const void* data, size_t bytes) {
+        static const char zeros[kPageSize] = {};
+        while (written < pos) {
+            size_t gap = static_cast<size_t>(std::min<uint64_t>(pos - written, kPageSize));
+            file.write(zeros, static_cast<std::streamsize>(gap));
+            written += gap;
+        }
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written += bytes;
+    }
+
+    // Formats numbers into a buffer that is written out in large blocks
+    class TextWriter {
+    public:
+        explicit TextWriter(std::ofstream& file) : file_(file) {
+            buffer_.reserve(kBlock + 64);
+        }
+
+        template <typename T>
+        void Number(T value) {
+            char digits[64];
+            auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), +value);
+            buffer_.append(digits, end);
+            if (buffer_.size() >= kBlock) {
+                Flush();
+            }
+        }
+
+        void Char(char c) {
+            buffer_.push_back(c);
+            if (buffer_.size() >= kBlock) {
+                Flush();
+            }
+        }
+
+        void Flush() {
+            file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+
+    private:
+        static constexpr size_t kBlock = 1 << 20;
+        std::ofstream& file_;
+        std::string buffer_;
+    };
+
+    // Common tail of the constructors once the rows are in place. A snapshot
+    // already carries the counts and the directedness.
+    void Initialize(Directedness directedness, bool from_snapshot) {
+        Clock::time_point start = Clock::now();
+        arc_count_ = offsets_[size_ + 1];
+        if (storage_ == AUTO) {
+            storage_ = ChooseStorage();
+        }
+        BuildMatrix();
+        load_times_.build += Lap(start);
+        if (!from_snapshot) {
+            self_loops_ = CountSelfLoops();
+        }
+        if (directedness != DETECT) {
+            detect_directedness_ = false;
+            is_directed_ = directedness == DIRECTED;
+        } else if (!from_snapshot) {
+            asymmetric_arcs_ = CountAsymmetricArcs();
+            is_directed_ = asymmetric_arcs_ != 0;
+        }
+        load_times_.directedness += Lap(start);
+    }
+
+    // Renumbers vertex order[k] to k. Rows are rebuilt in the new numbering and
+    // re-sorted; the id map is composed so external ids stay the same.
+    void Relabel(const std::vector<int>& order) {
+        std::vector<int> rank(size_ + 1, 0);
+        for (int k = 1; k <= size_; ++k) {
+            rank[order[k]] = k;
+        }
+
+        std::vector<size_t> offsets(size_ + 2, 0);
+        std::vector<int> neighbors(arc_count_);
+        std::vector<weight_type> weights(Traits::kStored ? arc_count_ : 0);
+        std::vector<std::pair<int, weight_type>> row;
+        for (int k = 1; k <= size_; ++k) {
+            int u = order[k];
+            row.clear();
+            for (size_t i = offsets_[u]; i < RowEnd(u); ++i) {
+                row.emplace_back(rank[neighbors_[i]], WeightAt(i));
+            }
+            std::sort(row.begin(), row.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (size_t j = 0; j < row.size(); ++j) {
+                neighbors[offsets[k] + j] = row[j].first;
+                if constexpr (Traits::kStored) {
+                    weights[offsets[k] + j] = row[j].second;
+                }
+            }
+            offsets[k + 1] = offsets[k] + row.size();
+        }
+
+        auto map = std::make_shared<IdMap>(static_cast<size_t>(size_));
+        for (int k = 1; k <= size_; ++k) {
+            map->Insert(ids_ ? ids_->External(order[k]) : order[k]);
+        }
+        ids_ = std::move(map);
+        SetCsr(std::move(offsets), std::move(neighbors), std::move(weights));
+        BuildMatrix();
+        DropCaches();
+    }
+
+    [[nodiscard]] size_t CountSelfLoops() const {
+        size_t loops = 0;
+        for (int u = 1; u <= size_; ++u) {
+            for (size_t i = offsets_[u]; i < RowEnd(u); ++i) {
+                loops += neighbors_[i] == u;
+            }
+        }
+        return loops;
+    }
+
+    // Rows in vertex order without slack or dead slots
+    void CompactInto(std::vector<size_t>& offsets, std::vector<int>& neighbors,
+                     std::vector<weight_type>& weights) const {
+        offsets.assign(size_ + 2, 0);
+        neighbors.clear();
+        neighbors.reserve(arc_count_);
+        weights.clear();
+        if constexpr (Traits::kStored) {
+            weights.reserve(arc_count_);
         }
-        file >> size_;
-        adjacency_matrix_.resize(size_ + 1, std::vector<int>(size_ + 1, 0));
-        std::string line;
-        std::getline(file, line); // Consume the remaining part of the first line
         for (int u = 1; u <= size_; ++u) {
-            std::getline(file, line);
-            std::istringstream iss(line);
-            std::string token;
-            while (iss >> token) {
-                size_t colon_pos = token.find(':');
-                int v, weight = 1;
-                if (colon_pos != std::string::npos) {
-                    v = std::stoi(token.substr(0, colon_pos));
-                    weight = std::stoi(token.substr(colon_pos + 1));
+            offsets[u] = neighbors.size();
+            neighbors.insert(neighbors.end(), neighbors_.begin() + offsets_[u], neighbors_.begin() + RowEnd(u));
+            if constexpr (Traits::kStored) {
+                weights.insert(weights.end(), weights_.begin() + offsets_[u], weights_.begin() + RowEnd(u));
+            }
+        }
+        offsets[size_ + 1] = neighbors.size();
+    }
+
+    // Back to plain CSR after mutations
+    void Compact() {
+        if (ends_.empty()) {
+            return;
+        }
+        std::vector<size_t> offsets;
+        std::vector<int> neighbors;
+        std::vector<weight_type> weights;
+        CompactInto(offsets, neighbors, weights);
+        SetCsr(std::move(offsets), std::move(neighbors), std::move(weights));
+        std::vector<size_t>().swap(ends_);
+        std::vector<size_t>().swap(limits_);
+        garbage_ = 0;
+        DropCaches();
+    }
+
+    // Switches to growable rows; mapped snapshot sections are copied out here
+    void Thaw() {
+        if (!ends_.empty()) {
+            return;
+        }
+        const auto& offsets = offsets_.Mutable();
+        neighbors_.Mutable();
+        weights_.Mutable();
+        ends_.assign(offsets.begin() + 1, offsets.end());
+        limits_ = ends_;
+    }
+
+    // Moves row u to the back of neighbors_ with room for twice its degree
+    void Relocate(int u) {
+        if (garbage_ > neighbors_.size() / 2) {
+            Compact();
+            Thaw();
+        }
+        auto& offsets = offsets_.Mutable();
+        auto& neighbors = neighbors_.Mutable();
+        size_t begin = offsets[u];
+        size_t degree = ends_[u] - begin;
+        size_t capacity = std::max<size_t>(4, 2 * degree);
+        size_t moved = neighbors.size();
+        neighbors.resize(moved + capacity);
+        std::copy_n(neighbors.begin() + begin, degree, neighbors.begin() + moved);
+        if constexpr (Traits::kStored) {
+            auto& weights = weights_.Mutable();
+            weights.resize(moved + capacity);
+            std::copy_n(weights.begin() + begin, degree, weights.begin() + moved);
+        }
+        garbage_ += limits_[u] - begin;
+        offsets[u] = moved;
+        ends_[u] = moved + degree;
+        limits_[u] = moved + capacity;
+    }
+
+    // How many of (u, v) and (v, u) lack a matching reverse arc
+    static size_t AsymmetricPair(weight_type forward, weight_type reverse) {
+        return (forward != 0 && forward != reverse) + (reverse != 0 && reverse != forward);
+    }
+
+    // Sets arc (u, v) to `value`, 0 removes it; returns the previous weight.
+    // Binary search in the row plus a shift of its tail.
+    weight_type SetArc(int u, int v, weight_type value) {
+        if constexpr (!Traits::kStored) {
+            value = value != 0;
+        }
+        Thaw();
+        size_t begin = offsets_[u];
+        size_t end = ends_[u];
+        size_t i = std::lower_bound(neighbors_.begin() + begin, neighbors_.begin() + end, v) - neighbors_.begin();
+        bool found = i < end && neighbors_[i] == v;
+        weight_type old = found ? WeightAt(i) : 0;
+        if (old == value) {
+            return old;
+        }
+        weight_type reverse = detect_directedness_ && u != v ? weight(v, u) : 0;
+        DropCaches();
+
+        if (value == 0) {
+            auto& neighbors = neighbors_.Mutable();
+            std::copy(neighbors.begin() + i + 1, neighbors.begin() + end, neighbors.begin() + i);
+            if constexpr (Traits::kStored) {
+                auto& weights = weights_.Mutable();
+                std::copy(weights.begin() + i + 1, weights.begin() + end, weights.begin() + i);
+            }
+            --ends_[u];
+            --arc_count_;
+            self_loops_ -= u == v;
+        } else if (found) {
+            if constexpr (Traits::kStored) {
+                weights_.Mutable()[i] = value;
+            }
+        } else {
+            if (end == limits_[u]) {
+                Relocate(u);
+                i = offsets_[u] + (i - begin);
+                end = ends_[u];
+            }
+            auto& neighbors = neighbors_.Mutable();
+            std::copy_backward(neighbors.begin() + i, neighbors.begin() + end, neighbors.begin() + end + 1);
+            neighbors[i] = v;
+            if constexpr (Traits::kStored) {
+                auto& weights = weights_.Mutable();
+                std::copy_backward(weights.begin() + i, weights.begin() + end, weights.begin() + end + 1);
+                weights[i] = value;
+            }
+            ++ends_[u];
+            ++arc_count_;
+            self_loops_ += u == v;
+        }
+
+        if (detect_directedness_ && u != v) {
+            asymmetric_arcs_ = asymmetric_arcs_ + AsymmetricPair(value, reverse) - AsymmetricPair(old, reverse);
+        }
+        if (!adjacency_matrix_.empty()) {
+            adjacency_matrix_.Mutable()[static_cast<size_t>(u) * (size_ + 1) + v] = value;
+        } else if (!adjacency_bits_.empty()) {
+            if (value != 0) {
+                adjacency_bits_.set(u, v);
+            } else {
+                adjacency_bits_.reset(u, v);
+            }
+        }
+        return old;
+    }
+
+    void UpdateDirectedness() {
+        if (detect_directedness_) {
+            is_directed_ = asymmetric_arcs_ != 0;
+        }
+    }
+
+    int AppendVertex() {
+        Thaw();
+        auto& offsets = offsets_.Mutable();
+        size_t end = neighbors_.size();
+        ++size_;
+        offsets[size_] = end;
+        offsets.push_back(end);
+        ends_.push_back(end);
+        limits_.push_back(end);
+        BuildMatrix();
+        DropCaches();
+        return size_;
+    }
+
+    // `count` writable elements for derived rows: owned by the buffer, or in a
+    // temporary file when the graph's own rows stay out of core
+    template <typename T>
+    T* AllocateDerived(Buffer<T>& buffer, size_t count) const {
+        if (storage_ != EXTERNAL) {
+            buffer = std::vector<T>(count);
+            return buffer.Mutable().data();
+        }
+        auto file = std::make_shared<MappedFile>(MappedFile::Temporary(count * sizeof(T)));
+        T* data = reinterpret_cast<T*>(file->writable_data());
+        buffer = Buffer<T>::View(std::move(file), 0, count);
+        return data;
+    }
+
+    // Counting sort of the arcs by target. Each transposed row comes out already
+    // ordered by source: O(V+E).
+    [[nodiscard]] DerivedRows Transpose() const {
+        DerivedRows in;
+        in.offsets.assign(size_ + 2, 0);
+        for (int u = 1; u <= size_; ++u) {
+            for (size_t i = offsets_[u]; i < RowEnd(u); ++i) {
+                ++in.offsets[CheckedNeighbor(i) + 1];
+            }
+        }
+        for (int v = 1; v <= size_ + 1; ++v) {
+            in.offsets[v] += in.offsets[v - 1];
+        }
+        int* neighbors = AllocateDerived(in.neighbors, arc_count_);
+        weight_type* weights = Traits::kStored ? AllocateDerived(in.weights, arc_count_) : nullptr;
+        std::vector<size_t> next(in.offsets.begin(), in.offsets.end() - 1);
+        for (int u = 1; u <= size_; ++u) {
+            for (size_t i = offsets_[u]; i < RowEnd(u); ++i) {
+                size_t j = next[neighbors_[i]]++;
+                neighbors[j] = u;
+                if constexpr (Traits::kStored) {
+                    weights[j] = weights_[i];
+                }
+            }
+        }
+        return in;
+    }
+
+    // Merges every row with its transpose; a pair of opposite arcs becomes one
+    // entry with the weight of the outgoing arc. The merge runs twice, to size
+    // the rows and then to fill them, so nothing is allocated beyond the result.
+    [[nodiscard]] DerivedRows Symmetrize(const DerivedRows& in) const {
+        // Calls emit(vertex, weight) for the merged row of v
+        auto merge = [this, &in](int v, auto emit) {
+            size_t out = offsets_[v], out_end = RowEnd(v);
+            size_t i = in.offsets[v], in_end = in.offsets[v + 1];
+            while (out < out_end || i < in_end) {
+                if (i == in_end || (out < out_end && neighbors_[out] <= in.neighbors[i])) {
+                    if (i < in_end && neighbors_[out] == in.neighbors[i]) {
+                        ++i;
+                    }
+                    emit(neighbors_[out], WeightAt(out));
+                    ++out;
                 } else {
-                    v = std::stoi(token);
+                    emit(in.neighbors[i], Traits::kStored ? in.weights[i] : 1);
+                    ++i;
                 }
-                adjacency_matrix_[u][v] = weight;
             }
+        };
+        DerivedRows both;
+        both.offsets.assign(size_ + 2, 0);
+        for (int v = 1; v <= size_; ++v) {
+            size_t count = 0;
+            merge(v, [&count](int, weight_type) { ++count; });
+            both.offsets[v + 1] = both.offsets[v] + count;
+        }
+        int* neighbors = AllocateDerived(both.neighbors, both.offsets[size_ + 1]);
+        weight_type* weights = Traits::kStored ? AllocateDerived(both.weights, both.offsets[size_ + 1]) : nullptr;
+        for (int v = 1; v <= size_; ++v) {
+            size_t j = both.offsets[v];
+            merge(v, [&](int u, weight_type weight) {
+                neighbors[j] = u;
+                if constexpr (Traits::kStored) {
+                    weights[j] = weight;
+                }
+                ++j;
+            });
         }
-        file.close();
+        return both;
+    }
+
+    // The rows equal their transpose exactly when no arc is asymmetric
+    [[nodiscard]] bool IsSymmetric() const {
+        return detect_directedness_ && asymmetric_arcs_ == 0;
+    }
+
+    [[nodiscard]] const DerivedRows& InRows() const {
+        return in_rows_.Get([this] { return Transpose(); });
+    }
+
+    [[nodiscard]] const DerivedRows& UndirectedRows() const {
+        return undirected_rows_.Get([this] { return Symmetrize(InRows()); });
     }
 
-    [[nodiscard]] bool CheckDirected() const {
+    // Rows are scanned by ascending source, so the search for u in row v can
+    // resume where the previous arc into v stopped: O(V+E) in total
+    [[nodiscard]] std::vector<size_t> FindReverseEdges() const {
+        std::vector<size_t> reverse(neighbors_.size(), kNoEdge);
+        std::vector<size_t> cursor(size_ + 1);
+        for (int v = 1; v <= size_; ++v) {
+            cursor[v] = offsets_[v];
+        }
         for (int u = 1; u <= size_; ++u) {
-            for (int v = 1; v <= size_; ++v) {
-                if (adjacency_matrix_[u][v] != adjacency_matrix_[v][u]) {
-                    return true;
+            for (size_t i = offsets_[u]; i < RowEnd(u); ++i) {
+                int v = CheckedNeighbor(i);
+                size_t& j = cursor[v];
+                size_t end = RowEnd(v);
+                while (j < end && neighbors_[j] < u) {
+                    ++j;
+                }
+                if (j < end && neighbors_[j] == u) {
+                    reverse[i] = j;
                 }
             }
         }
-        return false;
+        return reverse;
     }
 
-public:
-    enum FileType {
-        MATRIX,
-        EDGES_LIST,
-        ADJACENCY_LIST
-    };
+    [[nodiscard]] const std::vector<size_t>& ReverseEdges() const {
+        return reverse_edges_.Get([this] { return FindReverseEdges(); });
+    }
 
-    Graph(const std::string& path, FileType type) {
+    void DropCaches() {
+        in_rows_.Reset();
+        undirected_rows_.Reset();
+        reverse_edges_.Reset();
+    }
+
+    // Looks up (v, u) for every arc (u, v) with the cursors of FindReverseEdges():
+    // O(V+E) time and O(V) extra memory, no transpose
+    [[nodiscard]] size_t CountAsymmetricArcs() const {
+        std::vector<size_t> cursor(size_ + 1);
+        for (int v = 1; v <= size_; ++v) {
+            cursor[v] = offsets_[v];
+        }
+        size_t asymmetric = 0;
+        for (int u = 1; u <= size_; ++u) {
+            for (size_t i = offsets_[u]; i < RowEnd(u); ++i) {
+                int v = neighbors_[i];
+                size_t& j = cursor[v];
+                size_t end = RowEnd(v);
+                while (j < end && neighbors_[j] < u) {
+                    ++j;
+                }
+                asymmetric += j == end || neighbors_[j] != u || WeightAt(j) != WeightAt(i);
+            }
+        }
+        return asymmetric;
+    }
+
+public:
+    BasicGraph(const std::string& path, FileType type, Storage storage = AUTO, Directedness directedness = DETECT,
+               VertexIds ids = INDEX_IDS)
+            : storage_(storage) {
+        if (ids == EXTERNAL_IDS && type != EDGES_LIST && type != BINARY) {
+            throw std::invalid_argument("External ids need an edge list");
+        }
+        if (storage == EXTERNAL && type != BINARY) {
+            throw std::invalid_argument("EXTERNAL storage needs a BINARY snapshot");
+        }
         switch (type) {
+            case BINARY:
+                LoadBinary(path);
+                break;
             case MATRIX:
                 LoadMatrix(path);
                 break;
             case EDGES_LIST:
-                LoadEdgesList(path);
+                LoadEdgesList(path, ids);
                 break;
             case ADJACENCY_LIST:
                 LoadAdjacencyList(path);
@@ -117,77 +1472,597 @@ public:
             default:
                 throw std::invalid_argument("Invalid file type");
         }
-        is_directed_ = CheckDirected();
+        Initialize(directedness, type == BINARY);
+    }
+
+    // Builds the graph from arcs over vertices 1..size, as an edge list with the
+    // same lines would load: a repeated (u, v) keeps the last weight, a zero
+    // weight means no edge.
+    BasicGraph(int size, std::vector<Edge> edges, Storage storage = AUTO, Directedness directedness = DETECT)
+            : size_(size), storage_(storage) {
+        if (size < 0) {
+            throw std::invalid_argument("Invalid vertex count");
+        }
+        if (storage == EXTERNAL) {
+            throw std::invalid_argument("EXTERNAL storage needs a BINARY snapshot");
+        }
+        Clock::time_point start = Clock::now();
+        BuildFromArcs(edges, true);
+        load_times_.build += Lap(start);
+        Initialize(directedness, false);
+    }
+
+    // Writes a snapshot that Graph(path, BINARY) maps back without parsing
+    void save_binary(const std::string& path) const {
+        const size_t* offsets = offsets_.data();
+        const int* neighbors = neighbors_.data();
+        const weight_type* weights = weights_.data();
+        std::vector<size_t> packed_offsets;
+        std::vector<int> packed_neighbors;
+        std::vector<weight_type> packed_weights;
+        if (!ends_.empty()) {
+            CompactInto(packed_offsets, packed_neighbors, packed_weights);
+            offsets = packed_offsets.data();
+            neighbors = packed_neighbors.data();
+            weights = packed_weights.data();
+        }
+        size_t offsets_bytes = (size_ + 2) * sizeof(size_t);
+        size_t neighbors_bytes = arc_count_ * sizeof(int);
+        size_t weights_bytes = Traits::kStored ? arc_count_ * sizeof(weight_type) : 0;
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+        header.version = kSnapshotVersion;
+        header.flags = (is_directed_ ? kSnapshotDirected : 0) | (ids_ ? kSnapshotExternalIds : 0) |
+                       (detect_directedness_ ? kSnapshotDetected : 0);
+        header.size = size_;
+        header.arc_count = arc_count_;
+        header.asymmetric_arcs = asymmetric_arcs_;
+        header.self_loops = self_loops_;
+        header.offset_bytes = sizeof(size_t);
+        header.weight_bytes = static_cast<uint32_t>(Traits::kStored ? sizeof(weight_type) : 0);
+        header.weight_kind = Traits::kKind;
+        header.offsets_pos = AlignToPage(sizeof(header));
+        header.neighbors_pos = AlignToPage(header.offsets_pos + offsets_bytes);
+        header.weights_pos = AlignToPage(header.neighbors_pos + neighbors_bytes);
+        header.ids_pos = ids_ ? AlignToPage(header.weights_pos + weights_bytes) : 0;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file");
+        }
+        uint64_t written = 0;
+        WriteAt(file, written, 0, &header, sizeof(header));
+        WriteAt(file, written, header.offsets_pos, offsets, offsets_bytes);
+        WriteAt(file, written, header.neighbors_pos, neighbors, neighbors_bytes);
+        WriteAt(file, written, header.weights_pos, weights, weights_bytes);
+        if (ids_) {
+            WriteAt(file, written, header.ids_pos, ids_->externals().data(), ids_->externals().size() * sizeof(int64_t));
+        }
+        if (!file) {
+            throw std::runtime_error("Cannot write file");
+        }
+    }
+
+    // Writes the graph in any format the constructor reads. Text formats number
+    // the vertices 1..size() as the graph does now; only save_binary() keeps
+    // external ids.
+    void save(const std::string& path, FileType type) const {
+        if (type == BINARY) {
+            save_binary(path);
+            return;
+        }
+        if (type != MATRIX && type != EDGES_LIST && type != ADJACENCY_LIST) {
+            throw std::invalid_argument("Invalid file type");
+        }
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file");
+        }
+        TextWriter out(file);
+        out.Number(size_);
+        out.Char('\n');
+        for (int u = 1; u <= size_; ++u) {
+            size_t i = offsets_[u], end = RowEnd(u);
+            if (type == MATRIX) {
+                for (int v = 1; v <= size_; ++v) {
+                    if (i < end && neighbors_[i] == v) {
+                        out.Number(WeightAt(i++));
+                    } else {
+                        out.Char('0');
+                    }
+                    out.Char(' ');
+                }
+                out.Char('\n');
+            } else if (type == EDGES_LIST) {
+                for (; i < end; ++i) {
+                    out.Number(u);
+                    out.Char(' ');
+                    out.Number(neighbors_[i]);
+                    if constexpr (Traits::kStored) {
+                        out.Char(' ');
+                        out.Number(weights_[i]);
+                    }
+                    out.Char('\n');
+                }
+            } else {
+                for (; i < end; ++i) {
+                    out.Number(neighbors_[i]);
+                    if constexpr (Traits::kStored) {
+                        out.Char(':');
+                        out.Number(weights_[i]);
+                    }
+                    out.Char(' ');
+                }
+                out.Char('\n');
+            }
+        }
+        out.Flush();
+        if (!file) {
+            throw std::runtime_error("Cannot write file");
+        }
     }
 
     [[nodiscard]] int size() const {
         return size_;
     }
 
-    [[nodiscard]] int weight(int u, int v) const {
-        if (u < 1 || u > size_ || v < 1 || v > size_) {
-            throw std::out_of_range("Vertex index out of range");
+    // The layout in use; never AUTO
+    [[nodiscard]] Storage storage() const {
+        return storage_;
+    }
+
+    // Relabels the vertices for locality of traversals. Vertex numbers seen by
+    // callers change, external_id() still returns the id from the input file.
+    void reorder(Ordering ordering) {
+        Compact();
+        std::vector<int> order;
+        switch (ordering) {
+            case REVERSE_CUTHILL_MCKEE:
+                order = Reordering::ReverseCuthillMcKee(offsets_.data(), neighbors_.data(), size_);
+                break;
+            case DEGREE_ORDER:
+                order = Reordering::ByDegree(offsets_.data(), size_);
+                break;
+            case BFS_ORDER:
+                order = Reordering::ByBfs(offsets_.data(), neighbors_.data(), size_);
+                break;
+            default:
+                throw std::invalid_argument("Invalid ordering");
+        }
+        Relabel(order);
+    }
+
+    // Splits 1..size() into `parts` consecutive ranges of about equal work, one
+    // unit per vertex and one per arc: part k is ranges[k] .. ranges[k + 1] - 1,
+    // and trailing parts may be empty
+    [[nodiscard]] std::vector<int> vertex_ranges(int parts) const {
+        if (parts < 1) {
+            throw std::invalid_argument("Part count must be positive");
+        }
+        std::vector<int> ranges(parts + 1, size_ + 1);
+        ranges[0] = 1;
+        size_t total = size_ + arc_count_;
+        size_t done = 0;
+        int k = 1;
+        for (int v = 1; v <= size_ && k < parts; ++v) {
+            while (k < parts && done * parts >= total * k) {
+                ranges[k++] = v;
+            }
+            done += 1 + RowEnd(v) - offsets_[v];
+        }
+        return ranges;
+    }
+
+    // Copies the rows, and the weight matrix of DENSE storage, into fresh pages
+    // laid out for `workers`: each worker writes part w of vertex_ranges() from a
+    // thread pinned to its CPU. A kernel that hands part w to worker w of the same
+    // Workers then reads its own rows from local memory. Copies of the graph share
+    // the pages; any change moves the arrays back to the ordinary heap. The bit
+    // matrix and the caches behind in_neighbors() and the like are not placed.
+    void place(Placement placement, const Numa::Workers& workers) {
+        Compact();
+        int parts = workers.size();
+        std::vector<int> ranges = vertex_ranges(parts);
+        size_t stride = size_ + 1;
+        bool matrix = !adjacency_matrix_.empty();
+        // Element bounds of every part; vertex 0 goes with the first part and the
+        // closing offset with the last
+        std::vector<size_t> offset_first(parts + 1), arc_first(parts + 1), cell_first(parts + 1, 0);
+        for (int w = 0; w <= parts; ++w) {
+            if (w == 0 || w == parts) {
+                offset_first[w] = w == 0 ? 0 : size_ + 2;
+                arc_first[w] = w == 0 ? 0 : arc_count_;
+                cell_first[w] = w == 0 ? 0 : adjacency_matrix_.size();
+            } else {
+                offset_first[w] = ranges[w];
+                arc_first[w] = offsets_[ranges[w]];
+                cell_first[w] = matrix ? ranges[w] * stride : 0;
+            }
+        }
+
+        auto offsets = Reserve<size_t>(size_ + 2, offset_first, placement, workers);
+        auto neighbors = Reserve<int>(arc_count_, arc_first, placement, workers);
+        auto weights = Reserve<weight_type>(weights_.size(), arc_first, placement, workers);
+        auto cells = Reserve<weight_type>(adjacency_matrix_.size(), cell_first, placement, workers);
+        workers.Run([&](int w) {
+            CopyPart(offsets_, *offsets, offset_first, w);
+            CopyPart(neighbors_, *neighbors, arc_first, w);
+            if constexpr (Traits::kStored) {
+                CopyPart(weights_, *weights, arc_first, w);
+            }
+            if (matrix) {
+                CopyPart(adjacency_matrix_, *cells, cell_first, w);
+            }
+        });
+        offsets_ = Buffer<size_t>::View(offsets, 0, size_ + 2);
+        neighbors_ = Buffer<int>::View(neighbors, 0, arc_count_);
+        weights_ = Buffer<weight_type>::View(weights, 0, weights_.size());
+        adjacency_matrix_ = Buffer<weight_type>::View(cells, 0, adjacency_matrix_.size());
+    }
+
+    // True when vertex numbers differ from the ids in the input file
+    [[nodiscard]] bool has_external_ids() const {
+        return ids_ != nullptr;
+    }
+
+    // Id of v in the input file; v itself unless loaded with EXTERNAL_IDS
+    [[nodiscard]] int64_t external_id(int v) const {
+        CheckVertex(v);
+        return ids_ ? ids_->External(v) : v;
+    }
+
+    // Inverse of external_id()
+    [[nodiscard]] int internal_id(int64_t id) const {
+        int v = 0;
+        if (ids_) {
+            v = ids_->Find(id);
+        } else if (id >= 1 && id <= size_) {
+            v = static_cast<int>(id);
+        }
+        if (v == 0) {
+            throw std::out_of_range("Unknown vertex id");
+        }
+        return v;
+    }
+
+    [[nodiscard]] weight_type weight(int u, int v) const {
+        CheckVertex(u);
+        CheckVertex(v);
+        if (!adjacency_matrix_.empty()) {
+            return adjacency_matrix_[static_cast<size_t>(u) * (size_ + 1) + v];
+        }
+        if (!adjacency_bits_.empty()) {
+            if (!adjacency_bits_.test(u, v)) {
+                return 0;
+            }
+            if constexpr (!Traits::kStored) {
+                return 1;
+            }
         }
-        return adjacency_matrix_[u][v];
+        size_t i = FindArc(u, v);
+        return i == neighbors_.size() ? 0 : WeightAt(i);
     }
 
     bool is_edge(int u, int v) const {
         return weight(u, v) != 0;
     }
 
-    [[nodiscard]] std::vector<std::vector<int>> adjacency_matrix() const {
-        std::vector<std::vector<int>> matrix(size_ + 1, std::vector<int>(size_ + 1, 0));
+    // Deep copy; matrix_view() and weight() read the graph in place
+    [[nodiscard]] std::vector<std::vector<weight_type>> adjacency_matrix() const {
+        std::vector<std::vector<weight_type>> matrix(size_ + 1, std::vector<weight_type>(size_ + 1, 0));
         for (int u = 1; u <= size_; ++u) {
-            for (int v = 1; v <= size_; ++v) {
-                matrix[u][v] = adjacency_matrix_[u][v];
+            for (size_t i = offsets_[u]; i < RowEnd(u); ++i) {
+                matrix[u][neighbors_[i]] = WeightAt(i);
             }
         }
         return matrix;
     }
 
+    // Empty unless the storage is DENSE and the graph is weighted
+    [[nodiscard]] MatrixView matrix_view() const {
+        return {adjacency_matrix_.empty() ? nullptr : adjacency_matrix_.data(), static_cast<size_t>(size_) + 1};
+    }
+
+    // Row u has bit v set for every arc (u, v). nullptr unless the storage is
+    // BITSET, or DENSE for an Unweighted graph.
+    [[nodiscard]] const BitMatrix* adjacency_bits() const {
+        return adjacency_bits_.empty() ? nullptr : &adjacency_bits_;
+    }
+
     [[nodiscard]] std::vector<int> adjacency_list(int v) const {
-        if (v < 1 || v > size_) {
-            throw std::out_of_range("Vertex index out of range");
+        CheckVertex(v);
+        return std::vector<int>(neighbors_.begin() + offsets_[v], neighbors_.begin() + RowEnd(v));
+    }
+
+    // Allocation-free alternative to adjacency_list(): yields {vertex, weight} pairs
+    [[nodiscard]] NeighborRange neighbors(int v) const {
+        CheckVertex(v);
+        const weight_type* weights = Traits::kStored ? weights_.data() + offsets_[v] : nullptr;
+        return {neighbors_.data() + offsets_[v], weights, RowEnd(v) - offsets_[v]};
+    }
+
+    // Asks for v's row to be read in before it is needed; a no-op unless the rows
+    // live in a file: a mapped snapshot, or the cached rows of EXTERNAL storage.
+    // Traversals call it as they queue v, so the read overlaps other work.
+    void prefetch(int v, Rows rows = OUT_ROWS) const {
+        CheckVertex(v);
+        if (rows != OUT_ROWS && !IsSymmetric()) {
+            const DerivedRows& derived = rows == IN_ROWS ? InRows() : UndirectedRows();
+            PrefetchRow(derived.neighbors, derived.weights, derived.offsets[v], derived.offsets[v + 1]);
+        } else {
+            PrefetchRow(neighbors_, weights_, offsets_[v], RowEnd(v));
         }
-        std::vector<int> list;
-        for (int u = 1; u <= size_; ++u) {
-            if (adjacency_matrix_[v][u] != 0) {
-                list.push_back(u);
-            }
+    }
+
+    [[nodiscard]] int degree(int v) const {
+        CheckVertex(v);
+        return static_cast<int>(RowEnd(v) - offsets_[v]);
+    }
+
+    // Edge ids. An arc is identified by its position in the rows: the arcs of v
+    // are first_edge_id(v) .. first_edge_id(v) + degree(v) - 1, in the order
+    // neighbors(v) yields them. Every id is below edge_id_bound(), so per-edge
+    // data fits one EdgeMap array. Right after loading or compact() the ids are
+    // exactly 0 .. arc_count() - 1; any change may renumber them.
+    [[nodiscard]] size_t edge_id_bound() const {
+        return neighbors_.size();
+    }
+
+    [[nodiscard]] size_t first_edge_id(int v) const {
+        CheckVertex(v);
+        return offsets_[v];
+    }
+
+    // Ids of v's arcs, in the order neighbors(v) yields them
+    [[nodiscard]] EdgeIdRange out_edges(int v) const {
+        CheckVertex(v);
+        return {offsets_[v], RowEnd(v)};
+    }
+
+    // Id of arc (u, v), kNoEdge if there is none: O(log deg)
+    [[nodiscard]] size_t edge_id(int u, int v) const {
+        CheckVertex(u);
+        CheckVertex(v);
+        size_t i = FindArc(u, v);
+        return i == neighbors_.size() ? kNoEdge : i;
+    }
+
+    [[nodiscard]] int edge_target(size_t id) const {
+        return neighbors_[id];
+    }
+
+    [[nodiscard]] weight_type edge_weight(size_t id) const {
+        return WeightAt(id);
+    }
+
+    // Id of (v, u) for the arc (u, v) with this id, kNoEdge if the reverse arc is
+    // missing. The pairing is built in O(V+E) on the first call and cached like
+    // in_neighbors(); an undirected edge is always a pair of arcs.
+    [[nodiscard]] size_t reverse_edge(size_t id) const {
+        return ReverseEdges()[id];
+    }
+
+    // Packs the rows after mutations, so that edge ids are dense again
+    void compact() {
+        Compact();
+    }
+
+    // Predecessors: {u, weight of (u, v)} for every arc (u, v), sorted by u.
+    // The transposed rows are built in O(V+E) on the first call and kept until the
+    // graph changes; a graph whose arcs all have a matching reverse answers from
+    // its own rows. With EXTERNAL storage the cached rows go to a temporary file,
+    // so RAM holds only their offsets. Like neighbors(), the range is invalidated
+    // by any change.
+    [[nodiscard]] NeighborRange in_neighbors(int v) const {
+        CheckVertex(v);
+        if (IsSymmetric()) {
+            return neighbors(v);
+        }
+        return InRows().Row(v);
+    }
+
+    [[nodiscard]] int in_degree(int v) const {
+        return static_cast<int>(in_neighbors(v).size());
+    }
+
+    // Vertices joined to v by an arc in either direction, each once, sorted.
+    // The weight is that of (v, u) if it exists, of (u, v) otherwise.
+    // Cached like in_neighbors().
+    [[nodiscard]] NeighborRange undirected_neighbors(int v) const {
+        CheckVertex(v);
+        if (IsSymmetric()) {
+            return neighbors(v);
+        }
+        return UndirectedRows().Row(v);
+    }
+
+    // Every arc of a directed graph, every edge of an undirected one once (u <= v),
+    // in row order. Lazy: nothing is copied, the range is invalidated by any change.
+    [[nodiscard]] EdgeRange edges() const {
+        return EdgeRange(this);
+    }
+
+    [[nodiscard]] std::vector<std::tuple<int, int, weight_type>> list_of_edges() const {
+        std::vector<std::tuple<int, int, weight_type>> list;
+        for (auto [u, v, weight] : edges()) {
+            list.emplace_back(u, v, weight);
         }
         return list;
     }
 
-    [[nodiscard]] std::vector<std::tuple<int, int, int>> list_of_edges() const {
-        std::vector<std::tuple<int, int, int>> edges;
-        for (int u = 1; u <= size_; ++u) {
-            for (int v = 1; v <= size_; ++v) {
-                if (adjacency_matrix_[u][v] != 0) {
-                    if (is_directed_ || u <= v) {
-                        edges.emplace_back(u, v, adjacency_matrix_[u][v]);
+    [[nodiscard]] std::vector<std::tuple<int, int, weight_type>> list_of_edges(int v) const {
+        CheckVertex(v);
+        std::vector<std::tuple<int, int, weight_type>> edges;
+        for (size_t i = offsets_[v]; i < RowEnd(v); ++i) {
+            edges.emplace_back(v, neighbors_[i], WeightAt(i));
+        }
+        return edges;
+    }
+
+    [[nodiscard]] bool is_directed() const {
+        return is_directed_;
+    }
+
+    // Number of stored arcs; an undirected edge is two arcs unless it is a loop
+    [[nodiscard]] size_t arc_count() const {
+        return arc_count_;
+    }
+
+    [[nodiscard]] size_t edge_count() const {
+        return is_directed_ ? arc_count_ : (arc_count_ + self_loops_) / 2;
+    }
+
+    // Sizes, degrees, memory and load times; O(V + E) for the degree summary
+    [[nodiscard]] GraphStats stats() const {
+        static const char* const kStorageNames[] = {"AUTO", "DENSE", "CSR", "BITSET", "EXTERNAL"};
+        GraphStats stats;
+        stats.vertices = size_;
+        stats.arcs = arc_count_;
+        stats.edges = edge_count();
+        stats.self_loops = self_loops_;
+        stats.directed = is_directed_;
+        stats.storage = kStorageNames[storage_];
+        double pairs = static_cast<double>(size_) * (size_ - 1);
+        if (pairs > 0) {
+            stats.density = is_directed_ ? (arc_count_ - self_loops_) / pairs
+                                         : (edge_count() - self_loops_) / (pairs / 2);
+        }
+
+        if (size_ > 0) {
+            std::vector<int> degrees(size_);
+            std::vector<char> touched(size_ + 1, 0);
+            size_t total = 0;
+            for (int u = 1; u <= size_; ++u) {
+                degrees[u - 1] = static_cast<int>(RowEnd(u) - offsets_[u]);
+                total += degrees[u - 1];
+                touched[u] |= degrees[u - 1] != 0;
+                if (is_directed_) {
+                    for (size_t i = offsets_[u]; i < RowEnd(u); ++i) {
+                        touched[neighbors_[i]] = 1;
                     }
                 }
             }
+            auto& summary = stats.degrees;
+            summary.isolated = static_cast<size_t>(std::count(touched.begin() + 1, touched.end(), 0));
+            summary.mean = static_cast<double>(total) / size_;
+            auto median = degrees.begin() + (size_ - 1) / 2;
+            std::nth_element(degrees.begin(), median, degrees.end());
+            summary.median = *median;
+            auto p99 = degrees.begin() + static_cast<size_t>(0.99 * (size_ - 1));
+            std::nth_element(median, p99, degrees.end());
+            summary.p99 = *p99;
+            auto [min, max] = std::minmax_element(degrees.begin(), degrees.end());
+            summary.min = *min;
+            summary.max = *max;
         }
-        return edges;
+
+        auto& memory = stats.memory;
+        size_t mapped = 0;
+        auto count = [&mapped](const auto& buffer, size_t& bytes) {
+            (buffer.is_mapped() ? mapped : bytes) += buffer.bytes();
+        };
+        auto count_rows = [&count](const DerivedRows* rows, size_t& bytes) {
+            if (rows != nullptr) {
+                bytes += rows->offsets.capacity() * sizeof(size_t);
+                count(rows->neighbors, bytes);
+                count(rows->weights, bytes);
+            }
+        };
+        count(offsets_, memory.offsets);
+        count(neighbors_, memory.neighbors);
+        count(weights_, memory.weights);
+        count_rows(in_rows_.Peek(), memory.in_rows);
+        count_rows(undirected_rows_.Peek(), memory.undirected_rows);
+        memory.mapped = mapped;
+        memory.matrix = adjacency_matrix_.bytes();
+        memory.bit_matrix = adjacency_bits_.bytes();
+        memory.ids = ids_ ? ids_->bytes() : 0;
+        memory.row_slack = (ends_.capacity() + limits_.capacity()) * sizeof(size_t);
+        if (const std::vector<size_t>* reverse = reverse_edges_.Peek()) {
+            memory.reverse_edges = reverse->capacity() * sizeof(size_t);
+        }
+        stats.load = load_times_;
+        return stats;
     }
 
-    [[nodiscard]] std::vector<std::tuple<int, int, int>> list_of_edges(int v) const {
-        if (v < 1 || v > size_) {
-            throw std::out_of_range("Vertex index out of range");
+    // Mutations. An edge of an undirected graph is updated in both directions;
+    // directedness is re-derived after every change unless it was declared at load.
+
+    // Adds the edge or replaces its weight
+    void add_edge(int u, int v, weight_type weight = 1) {
+        CheckVertex(u);
+        CheckVertex(v);
+        if (weight == 0) {
+            throw std::invalid_argument("Zero weight means no edge");
         }
-        std::vector<std::tuple<int, int, int>> edges;
-        for (int u = 1; u <= size_; ++u) {
-            if (adjacency_matrix_[v][u] != 0) {
-                edges.emplace_back(v, u, adjacency_matrix_[v][u]);
-            }
+        bool both = !is_directed_;
+        SetArc(u, v, weight);
+        if (both) {
+            SetArc(v, u, weight);
         }
-        return edges;
+        UpdateDirectedness();
     }
 
-    [[nodiscard]] bool is_directed() const {
-        return is_directed_;
+    // Returns false if there was no such edge
+    bool remove_edge(int u, int v) {
+        CheckVertex(u);
+        CheckVertex(v);
+        bool both = !is_directed_;
+        bool removed = SetArc(u, v, 0) != 0;
+        if (both) {
+            removed = SetArc(v, u, 0) != 0 || removed;
+        }
+        UpdateDirectedness();
+        return removed;
     }
+
+    void set_weight(int u, int v, weight_type weight) {
+        if (!is_edge(u, v)) {
+            throw std::invalid_argument("No such edge");
+        }
+        add_edge(u, v, weight);
+    }
+
+    // Appends an isolated vertex and returns its number. Amortized O(1) on CSR;
+    // DENSE and BITSET storage rebuild their matrix.
+    int add_vertex() {
+        if (ids_) {
+            throw std::logic_error("Graph has external ids, pass one to add_vertex");
+        }
+        return AppendVertex();
+    }
+
+    int add_vertex(int64_t id) {
+        if (!ids_ && id == static_cast<int64_t>(size_) + 1) {
+            return AppendVertex();
+        }
+        if (!ids_) {
+            ids_ = std::make_shared<IdMap>(static_cast<size_t>(size_) + 1);
+            for (int v = 1; v <= size_; ++v) {
+                ids_->Insert(v);
+            }
+        } else if (ids_.use_count() > 1) {
+            ids_ = std::make_shared<IdMap>(*ids_);
+        }
+        if (ids_->Find(id) != 0) {
+            throw std::invalid_argument("Vertex id already exists");
+        }
+        ids_->Insert(id);
+        return AppendVertex();
+    }
+};
+
+using Graph = BasicGraph<int>;
+
+// The W of a BasicGraph<W>, for building another graph with the same weights.
+// weight_type does not do: it is int for Unweighted as well.
+template <typename G>
+struct GraphWeight;
+
+template <typename W>
+struct GraphWeight<BasicGraph<W>> {
+    using type = W;
 };
 
 #endif //UNTITLED2_GRAPH_H
@@ -0,0 +1,117 @@
+//
+// What a loaded graph costs: memory per internal structure, counts, a degree
+// summary and the time each load phase took. BasicGraph::stats() fills it in;
+// print_json() writes one line of JSON, so runs can be collected and compared
+// by scripts. Task binaries print it to stderr when GRAPH_STATS is set.
+//
+
+#ifndef UNTITLED2_GRAPHSTATS_H
+#define UNTITLED2_GRAPHSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+
+// Seconds spent in each phase of loading. Reading is mapping the file (and
+// checking a snapshot); pages are faulted in by the parser, so with a cold page
+// cache most of the I/O is counted as parsing.
+struct LoadTimes {
+    double read = 0;
+    double parse = 0;
+    double build = 0;         // rows, the storage matrix and the id map
+    double directedness = 0;  // self loops and the symmetry check
+
+    [[nodiscard]] double total() const {
+        return read + parse + build + directedness;
+    }
+};
+
+struct GraphStats {
+    // Out-degrees; for an undirected graph, the number of neighbours
+    struct Degrees {
+        int min = 0;
+        int max = 0;
+        double mean = 0;
+        int median = 0;
+        int p99 = 0;
+        size_t isolated = 0;  // no arcs in either direction
+    };
+
+    // Bytes per structure. Rows of a BINARY snapshot are views of the mapped file
+    // and are counted under `mapped`, not under their own names; so are the
+    // cached rows of EXTERNAL storage, which live in a temporary file.
+    struct Memory {
+        size_t offsets = 0;
+        size_t neighbors = 0;
+        size_t weights = 0;
+        size_t matrix = 0;           // DENSE weight matrix
+        size_t bit_matrix = 0;       // BITSET, or DENSE for unweighted graphs
+        size_t ids = 0;              // external id table
+        size_t row_slack = 0;        // per-row ends and limits kept after mutations
+        size_t in_rows = 0;          // caches, zero until first used
+        size_t undirected_rows = 0;
+        size_t reverse_edges = 0;
+        size_t mapped = 0;
+
+        [[nodiscard]] size_t heap() const {
+            return offsets + neighbors + weights + matrix + bit_matrix + ids + row_slack + in_rows +
+                   undirected_rows + reverse_edges;
+        }
+    };
+
+    int vertices = 0;
+    size_t arcs = 0;
+    size_t edges = 0;
+    size_t self_loops = 0;
+    bool directed = false;
+    std::string storage;
+    // Share of the possible arcs (directed) or edges (undirected) that exist,
+    // loops not counted as possible
+    double density = 0;
+    Degrees degrees;
+    Memory memory;
+    LoadTimes load;
+
+    // True when the GRAPH_STATS environment variable is set
+    static bool Requested() {
+        return std::getenv("GRAPH_STATS") != nullptr;
+    }
+
+    void print_json(std::ostream& out) const {
+        out << "{\"vertices\":" << vertices
+            << ",\"arcs\":" << arcs
+            << ",\"edges\":" << edges
+            << ",\"self_loops\":" << self_loops
+            << ",\"directed\":" << (directed ? "true" : "false")
+            << ",\"storage\":\"" << storage << '"'
+            << ",\"density\":" << density
+            << ",\"degree\":{\"min\":" << degrees.min
+            << ",\"max\":" << degrees.max
+            << ",\"mean\":" << degrees.mean
+            << ",\"median\":" << degrees.median
+            << ",\"p99\":" << degrees.p99
+            << ",\"isolated\":" << degrees.isolated
+            << "},\"bytes\":{\"offsets\":" << memory.offsets
+            << ",\"neighbors\":" << memory.neighbors
+            << ",\"weights\":" << memory.weights
+            << ",\"matrix\":" << memory.matrix
+            << ",\"bit_matrix\":" << memory.bit_matrix
+            << ",\"ids\":" << memory.ids
+            << ",\"row_slack\":" << memory.row_slack
+            << ",\"in_rows\":" << memory.in_rows
+            << ",\"undirected_rows\":" << memory.undirected_rows
+            << ",\"reverse_edges\":" << memory.reverse_edges
+            << ",\"heap\":" << memory.heap()
+            << ",\"mapped\":" << memory.mapped
+            << "},\"load_seconds\":{\"read\":" << load.read
+            << ",\"parse\":" << load.parse
+            << ",\"build\":" << load.build
+            << ",\"directedness\":" << load.directedness
+            << ",\"total\":" << load.total()
+            << "}}\n";
+    }
+};
+
+#endif //UNTITLED2_GRAPHSTATS_H
@@ -0,0 +1,293 @@
+//
+// Breadth-first shortest paths on a Map. Per cell the search keeps one visited
+// bit and the 2-bit direction of the move that reached it, so a 10^8-cell grid
+// needs under 40 MB of scratch besides the queue (twice that once a
+// BIDIRECTIONAL search has run). The scratch is kept between searches on the
+// same map.
+//
+
+#ifndef UNTITLED2_GRIDBFS_H
+#define UNTITLED2_GRIDBFS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "map.h"
+
+class GridBfs {
+public:
+    using Cell = std::pair<int, int>;  // (row, column)
+
+    enum Mode {
+        FORWARD,       // one search from the start
+        BIDIRECTIONAL  // searches from both ends that meet in the middle
+    };
+
+private:
+    // Move that entered a cell
+    enum Direction {
+        UP,
+        DOWN,
+        LEFT,
+        RIGHT
+    };
+
+    static constexpr size_t kNoCell = SIZE_MAX;
+
+    // FIFO over a power-of-two ring that doubles when full
+    class RingQueue {
+    public:
+        void clear() {
+            head_ = 0;
+            size_ = 0;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return size_ == 0;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return size_;
+        }
+
+        void push(uint64_t value) {
+            if (size_ == slots_.size()) {
+                Grow();
+            }
+            slots_[(head_ + size_) & (slots_.size() - 1)] = value;
+            ++size_;
+        }
+
+        uint64_t pop() {
+            uint64_t value = slots_[head_];
+            head_ = (head_ + 1) & (slots_.size() - 1);
+            --size_;
+            return value;
+        }
+
+    private:
+        std::vector<uint64_t> slots_;
+        size_t head_ = 0;
+        size_t size_ = 0;
+
+        void Grow() {
+            std::vector<uint64_t> slots(std::max<size_t>(1024, slots_.size() * 2));
+            for (size_t k = 0; k < size_; ++k) {
+                slots[k] = slots_[(head_ + k) & (slots_.size() - 1)];
+            }
+            slots_ = std::move(slots);
+            head_ = 0;
+        }
+    };
+
+    // State of a search from one end
+    struct Search {
+        std::vector<uint64_t> visited;     // 1 bit per cell
+        std::vector<uint64_t> directions;  // 2 bits per cell, valid for visited cells
+        RingQueue queue;
+
+        void Reset(size_t cells) {
+            visited.assign((cells + 63) / 64, 0);
+            directions.resize((cells + 31) / 32);
+            queue.clear();
+        }
+
+        [[nodiscard]] bool Visited(size_t cell) const {
+            return (visited[cell / 64] >> (cell % 64)) & 1;
+        }
+
+        void Visit(size_t cell, Direction direction) {
+            visited[cell / 64] |= uint64_t{1} << (cell % 64);
+            uint64_t& word = directions[cell / 32];
+            unsigned shift = (cell % 32) * 2;
+            word = (word & ~(uint64_t{3} << shift)) | static_cast<uint64_t>(direction) << shift;
+        }
+
+        [[nodiscard]] Direction DirectionOf(size_t cell) const {
+            return static_cast<Direction>((directions[cell / 32] >> ((cell % 32) * 2)) & 3);
+        }
+    };
+
+    const Map& map_;
+    int rows_;
+    int cols_;
+    Search forward_;
+    Search backward_;  // empty until the first BIDIRECTIONAL search
+    size_t expanded_ = 0;
+
+    // Queue entries carry the row and column so no division is needed per cell
+    static uint64_t Pack(int i, int j) {
+        return static_cast<uint64_t>(i) << 32 | static_cast<uint32_t>(j);
+    }
+
+    [[nodiscard]] bool Inside(Cell cell) const {
+        return cell.first >= 0 && cell.first < rows_ && cell.second >= 0 && cell.second < cols_;
+    }
+
+    // Cells from `from` back to where `search` started, following its directions
+    [[nodiscard]] std::vector<Cell> Trace(const Search& search, Cell from, Cell to) const {
+        std::vector<Cell> path;
+        Cell current = from;
+        path.push_back(current);
+        while (current != to) {
+            switch (search.DirectionOf(map_.cell(current.first, current.second))) {
+                case UP:
+                    ++current.first;
+                    break;
+                case DOWN:
+                    --current.first;
+                    break;
+                case LEFT:
+                    ++current.second;
+                    break;
+                case RIGHT:
+                    --current.second;
+                    break;
+            }
+            path.push_back(current);
+        }
+        return path;
+    }
+
+    // Takes one cell off the search's queue and visits its neighbours up, down,
+    // left, right, entering `open_cell` even if it is a wall. Returns the first
+    // newly visited cell for which stop(cell) holds, kNoCell if there is none.
+    template <typename Stop>
+    size_t Expand(Search& search, size_t open_cell, Stop stop) {
+        uint64_t packed = search.queue.pop();
+        int i = static_cast<int>(packed >> 32);
+        int j = static_cast<int>(packed & 0xffffffffu);
+        size_t cols = cols_;
+        size_t cell = static_cast<size_t>(i) * cols + j;
+        ++expanded_;
+        auto reach = [&](int ni, int nj, size_t next, Direction direction) {
+            if ((!map_(ni, nj) && next != open_cell) || search.Visited(next)) {
+                return false;
+            }
+            search.Visit(next, direction);
+            search.queue.push(Pack(ni, nj));
+            return stop(next);
+        };
+        if (i > 0 && reach(i - 1, j, cell - cols, UP)) {
+            return cell - cols;
+        }
+        if (i + 1 < rows_ && reach(i + 1, j, cell + cols, DOWN)) {
+            return cell + cols;
+        }
+        if (j > 0 && reach(i, j - 1, cell - 1, LEFT)) {
+            return cell - 1;
+        }
+        if (j + 1 < cols_ && reach(i, j + 1, cell + 1, RIGHT)) {
+            return cell + 1;
+        }
+        return kNoCell;
+    }
+
+    std::vector<Cell> Forward(Cell start, Cell end) {
+        forward_.Reset(map_.cell_count());
+        size_t target = map_.cell(end.first, end.second);
+        forward_.Visit(map_.cell(start.first, start.second), UP);
+        forward_.queue.push(Pack(start.first, start.second));
+        while (!forward_.queue.empty()) {
+            if (Expand(forward_, kNoCell, [target](size_t cell) { return cell == target; }) != kNoCell) {
+                std::vector<Cell> path = Trace(forward_, end, start);
+                std::reverse(path.begin(), path.end());
+                return path;
+            }
+        }
+        return {};
+    }
+
+    // Expands whole layers, each time on the side with the smaller frontier. A
+    // cell the other side has visited is then at the other side's frontier depth,
+    // so the first meeting closes a shortest path.
+    std::vector<Cell> Bidirectional(Cell start, Cell end) {
+        if (!map_(end.first, end.second)) {
+            return {};
+        }
+        forward_.Reset(map_.cell_count());
+        backward_.Reset(map_.cell_count());
+        size_t from = map_.cell(start.first, start.second);
+        forward_.Visit(from, UP);
+        forward_.queue.push(Pack(start.first, start.second));
+        backward_.Visit(map_.cell(end.first, end.second), UP);
+        backward_.queue.push(Pack(end.first, end.second));
+
+        size_t meeting = kNoCell;
+        while (meeting == kNoCell && !forward_.queue.empty() && !backward_.queue.empty()) {
+            bool forward = forward_.queue.size() <= backward_.queue.size();
+            Search& search = forward ? forward_ : backward_;
+            const Search& other = forward ? backward_ : forward_;
+            // Moves from the start need an open target; backwards, the start
+            // cell itself may be a wall
+            size_t open_cell = forward ? kNoCell : from;
+            for (size_t layer = search.queue.size(); layer > 0 && meeting == kNoCell; --layer) {
+                meeting = Expand(search, open_cell, [&other](size_t cell) { return other.Visited(cell); });
+            }
+        }
+        if (meeting == kNoCell) {
+            return {};
+        }
+        Cell middle = {map_.cell_row(meeting), map_.cell_col(meeting)};
+        std::vector<Cell> path = Trace(forward_, middle, start);
+        std::reverse(path.begin(), path.end());
+        std::vector<Cell> rest = Trace(backward_, middle, end);
+        path.insert(path.end(), rest.begin() + 1, rest.end());
+        return path;
+    }
+
+public:
+    explicit GridBfs(const Map& map) : map_(map), rows_(map.size().first), cols_(map.size().second) {}
+
+    // Shortest path from start to end, both included; empty if end cannot be
+    // reached. The start cell itself need not be passable.
+    // FORWARD queues neighbours up, down, left, right and stops when end is first
+    // reached, so the path is the one a queue BFS over Map::neighbors() returns.
+    // BIDIRECTIONAL stops when the two searches meet; the path is as short, but
+    // among equally short paths it may take another one.
+    std::vector<Cell> find_path(Cell start, Cell end, Mode mode = FORWARD) {
+        expanded_ = 0;
+        if (start == end) {
+            return {start};
+        }
+        if (!Inside(start) || !Inside(end)) {
+            return {};
+        }
+        return mode == BIDIRECTIONAL ? Bidirectional(start, end) : Forward(start, end);
+    }
+
+    // Cell farthest from start: the last one a full search reaches, start itself
+    // if it reaches nothing. expanded() is then the size of start's component.
+    Cell farthest(Cell start) {
+        expanded_ = 0;
+        if (!Inside(start)) {
+            return start;
+        }
+        forward_.Reset(map_.cell_count());
+        size_t last = map_.cell(start.first, start.second);
+        forward_.Visit(last, UP);
+        forward_.queue.push(Pack(start.first, start.second));
+        while (!forward_.queue.empty()) {
+            Expand(forward_, kNoCell, [&last](size_t cell) {
+                last = cell;
+                return false;
+            });
+        }
+        return {map_.cell_row(last), map_.cell_col(last)};
+    }
+
+    // Whether the search from the start in the last find_path() or farthest()
+    // reached cell; after farthest(), whether cell is in start's component
+    [[nodiscard]] bool reached(Cell cell) const {
+        return Inside(cell) && !forward_.visited.empty() && forward_.Visited(map_.cell(cell.first, cell.second));
+    }
+
+    // Cells taken off the queues by the last find_path() or farthest()
+    [[nodiscard]] size_t expanded() const {
+        return expanded_;
+    }
+};
+
+#endif //UNTITLED2_GRIDBFS_H
@@ -0,0 +1,111 @@
+//
+// Bidirectional map between arbitrary 64-bit vertex ids and dense indices 1..n.
+//
+
+#ifndef UNTITLED2_IDMAP_H
+#define UNTITLED2_IDMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+class IdMap {
+private:
+    // Open addressing with linear probing; a slot holds a dense index, 0 if empty
+    std::vector<int> slots_;
+    size_t mask_ = 0;
+    // external_[v] is the id vertex v had in the input; external_[0] is unused
+    std::vector<int64_t> external_{0};
+
+    static size_t Hash(int64_t id) {
+        // splitmix64 finaliser: consecutive ids land far apart
+        uint64_t x = static_cast<uint64_t>(id) + 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<size_t>(x ^ (x >> 31));
+    }
+
+    void Grow() {
+        std::vector<int> old = std::move(slots_);
+        size_t capacity = old.empty() ? 64 : old.size() * 2;
+        slots_.assign(capacity, 0);
+        mask_ = capacity - 1;
+        for (int v : old) {
+            if (v != 0) {
+                size_t slot = Hash(external_[v]) & mask_;
+                while (slots_[slot] != 0) {
+                    slot = (slot + 1) & mask_;
+                }
+                slots_[slot] = v;
+            }
+        }
+    }
+
+public:
+    IdMap() = default;
+
+    explicit IdMap(size_t expected) {
+        Reserve(expected);
+    }
+
+    void Reserve(size_t expected) {
+        external_.reserve(expected + 1);
+        while (slots_.size() < expected * 2) {
+            Grow();
+        }
+    }
+
+    // Dense index of `id`, assigning the next free one on first sight
+    int Insert(int64_t id) {
+        if ((external_.size() + 1) * 2 > slots_.size()) {
+            Grow();
+        }
+        size_t slot = Hash(id) & mask_;
+        while (slots_[slot] != 0) {
+            if (external_[slots_[slot]] == id) {
+                return slots_[slot];
+            }
+            slot = (slot + 1) & mask_;
+        }
+        int v = static_cast<int>(external_.size());
+        external_.push_back(id);
+        slots_[slot] = v;
+        return v;
+    }
+
+    // Dense index of `id`, or 0 if it was never inserted
+    [[nodiscard]] int Find(int64_t id) const {
+        if (slots_.empty()) {
+            return 0;
+        }
+        size_t slot = Hash(id) & mask_;
+        while (slots_[slot] != 0) {
+            if (external_[slots_[slot]] == id) {
+                return slots_[slot];
+            }
+            slot = (slot + 1) & mask_;
+        }
+        return 0;
+    }
+
+    [[nodiscard]] int64_t External(int v) const {
+        return external_[v];
+    }
+
+    // Number of mapped ids, i.e. the largest dense index
+    [[nodiscard]] int size() const {
+        return static_cast<int>(external_.size()) - 1;
+    }
+
+    // external ids indexed by dense index, entry 0 unused
+    [[nodiscard]] const std::vector<int64_t>& externals() const {
+        return external_;
+    }
+
+    [[nodiscard]] size_t bytes() const {
+        return slots_.capacity() * sizeof(int) + external_.capacity() * sizeof(int64_t);
+    }
+};
+
+#endif //UNTITLED2_IDMAP_H
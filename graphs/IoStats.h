@@ -0,0 +1,49 @@
+//
+// Process I/O counters, sampled before and after a run to report how much it read.
+//
+
+#ifndef UNTITLED2_IOSTATS_H
+#define UNTITLED2_IOSTATS_H
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+struct IoCounters {
+    uint64_t read_bytes = 0;    // fetched from storage, page cache hits excluded (Linux only)
+    uint64_t major_faults = 0;  // page faults that had to wait for I/O
+
+    static IoCounters Sample() {
+        IoCounters counters;
+        std::ifstream io("/proc/self/io");
+        std::string key;
+        uint64_t value;
+        while (io >> key >> value) {
+            if (key == "read_bytes:") {
+                counters.read_bytes = value;
+            }
+        }
+#ifndef _WIN32
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            counters.major_faults = static_cast<uint64_t>(usage.ru_majflt);
+        }
+#endif
+        return counters;
+    }
+
+    IoCounters operator-(const IoCounters& other) const {
+        return {read_bytes - other.read_bytes, major_faults - other.major_faults};
+    }
+
+    void print(std::ostream& out) const {
+        out << "I/O: " << read_bytes / (1024.0 * 1024.0) << " MB read, " << major_faults << " major faults\n";
+    }
+};
+
+#endif //UNTITLED2_IOSTATS_H
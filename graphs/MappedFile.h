@@ -0,0 +1,288 @@
+//
+// Read-only memory mapping of a whole file, writable anonymous memory allocated
+// page by page on first touch, or a writable temporary file.
+//
+
+#ifndef UNTITLED2_MAPPEDFILE_H
+#define UNTITLED2_MAPPEDFILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile {
+public:
+    // Access pattern hints for a range of the mapping
+    enum Advice {
+        SEQUENTIAL,  // read ahead aggressively, drop pages behind
+        RANDOM,      // no read-ahead
+        WILLNEED     // start reading the range now
+    };
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool anonymous_ = false;
+    bool writable_ = false;
+    // One bit per kPrefetchPage bytes that Prefetch() has asked for; allocated on
+    // first use, which concurrent callers may race to do
+    mutable std::atomic<std::atomic<uint64_t>*> prefetched_{nullptr};
+
+    static constexpr size_t kPrefetchPage = 4096;
+
+    MappedFile() = default;
+
+    std::atomic<uint64_t>* PrefetchedPages() const {
+        std::atomic<uint64_t>* pages = prefetched_.load(std::memory_order_acquire);
+        if (pages == nullptr) {
+            auto* fresh = new std::atomic<uint64_t>[size_ / kPrefetchPage / 64 + 1]();
+            if (prefetched_.compare_exchange_strong(pages, fresh, std::memory_order_acq_rel)) {
+                pages = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        return pages;
+    }
+
+    void Release() {
+        delete[] prefetched_.exchange(nullptr);
+        if (data_ == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        if (anonymous_) {
+            VirtualFree(const_cast<char*>(data_), 0, MEM_RELEASE);
+        } else {
+            UnmapViewOfFile(data_);
+        }
+#else
+        munmap(const_cast<char*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Cannot open file");
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size)) {
+            CloseHandle(file);
+            throw std::runtime_error("Cannot open file");
+        }
+        size_ = static_cast<size_t>(file_size.QuadPart);
+        if (size_ > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file");
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot open file");
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            data_ = addr == MAP_FAILED ? nullptr : static_cast<const char*>(addr);
+        }
+        close(fd);
+#endif
+        if (size_ > 0 && data_ == nullptr) {
+            throw std::runtime_error("Cannot map file");
+        }
+    }
+
+    // Zero-filled memory that no file backs. No page exists until it is first
+    // written, so the writing thread (or a Numa policy set beforehand) decides
+    // which NUMA node it lands on.
+    static MappedFile Anonymous(size_t bytes) {
+        MappedFile memory;
+        memory.anonymous_ = true;
+        memory.writable_ = true;
+        memory.size_ = bytes;
+        if (bytes == 0) {
+            return memory;
+        }
+#ifdef _WIN32
+        memory.data_ = static_cast<const char*>(VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else
+        void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        memory.data_ = addr == MAP_FAILED ? nullptr : static_cast<const char*>(addr);
+#endif
+        if (memory.data_ == nullptr) {
+            memory.size_ = 0;
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    // Zero-filled writable pages backed by a new file in the temporary directory
+    // ($TMPDIR, /tmp). The file is deleted once the mapping is gone; the kernel
+    // writes the pages back to it and drops them under memory pressure, so the
+    // data need not fit in RAM.
+    static MappedFile Temporary(size_t bytes) {
+        MappedFile memory;
+        memory.writable_ = true;
+        memory.size_ = bytes;
+        if (bytes == 0) {
+            return memory;
+        }
+#ifdef _WIN32
+        char directory[MAX_PATH + 1];
+        char path[MAX_PATH + 1];
+        if (GetTempPathA(sizeof(directory), directory) == 0 || GetTempFileNameA(directory, "grf", 0, path) == 0) {
+            throw std::runtime_error("Cannot create temporary file");
+        }
+        HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                  FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Cannot create temporary file");
+        }
+        auto size = static_cast<unsigned long long>(bytes);
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                            static_cast<DWORD>(size), nullptr);
+        if (mapping != nullptr) {
+            memory.data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+#else
+        const char* directory = std::getenv("TMPDIR");
+        std::string path = std::string(directory != nullptr && *directory ? directory : "/tmp") + "/graph.XXXXXX";
+        int fd = mkstemp(path.data());
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create temporary file");
+        }
+        unlink(path.c_str());
+        if (ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+            void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            memory.data_ = addr == MAP_FAILED ? nullptr : static_cast<const char*>(addr);
+        }
+        close(fd);
+#endif
+        if (memory.data_ == nullptr) {
+            memory.size_ = 0;
+            throw std::runtime_error("Cannot map temporary file");
+        }
+        return memory;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+            : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+              anonymous_(other.anonymous_), writable_(other.writable_),
+              prefetched_(other.prefetched_.exchange(nullptr)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            anonymous_ = other.anonymous_;
+            writable_ = other.writable_;
+            prefetched_ = other.prefetched_.exchange(nullptr);
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        Release();
+    }
+
+    [[nodiscard]] const char* data() const {
+        return data_;
+    }
+
+    // Writable bytes of an anonymous or temporary mapping; mapped files are read-only
+    [[nodiscard]] char* writable_data() {
+        if (!writable_) {
+            throw std::logic_error("File mappings are read-only");
+        }
+        return const_cast<char*>(data_);
+    }
+
+    [[nodiscard]] bool is_anonymous() const {
+        return anonymous_;
+    }
+
+    // Hints the kernel about [begin, begin + bytes), which must lie inside a mapping.
+    // Failures are ignored: the hint only affects speed.
+    static void Advise(const void* begin, size_t bytes, Advice advice) {
+        if (bytes == 0) {
+            return;
+        }
+#ifdef _WIN32
+        if (advice == WILLNEED) {
+            WIN32_MEMORY_RANGE_ENTRY range{const_cast<void*>(begin), bytes};
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+        }
+#else
+        auto page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        auto first = reinterpret_cast<uintptr_t>(begin) / page * page;
+        auto last = reinterpret_cast<uintptr_t>(begin) + bytes;
+        int hint = advice == SEQUENTIAL ? MADV_SEQUENTIAL : advice == RANDOM ? MADV_RANDOM : MADV_WILLNEED;
+        madvise(reinterpret_cast<void*>(first), last - first, hint);
+#endif
+    }
+
+    [[nodiscard]] size_t size() const {
+        return size_;
+    }
+
+    // Advise(WILLNEED) for [begin, begin + bytes) inside this mapping, skipped when
+    // every page of the range was asked for before: rows that share a page cost
+    // one system call between them. A page evicted since is read in on access.
+    void Prefetch(const void* begin, size_t bytes) const {
+        if (bytes == 0) {
+            return;
+        }
+        size_t offset = static_cast<const char*>(begin) - data_;
+        std::atomic<uint64_t>* pages = PrefetchedPages();
+        bool fresh = false;
+        for (size_t page = offset / kPrefetchPage; page <= (offset + bytes - 1) / kPrefetchPage; ++page) {
+            uint64_t bit = uint64_t{1} << (page % 64);
+            if ((pages[page / 64].load(std::memory_order_relaxed) & bit) == 0) {
+                fresh |= (pages[page / 64].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+            }
+        }
+        if (fresh) {
+            Advise(begin, bytes, WILLNEED);
+        }
+    }
+};
+
+#endif //UNTITLED2_MAPPEDFILE_H
@@ -0,0 +1,261 @@
+//
+// NUMA topology, thread pinning and page placement. On Linux the nodes come from
+// sysfs and pages are placed with the mbind system call, so libnuma is not needed;
+// elsewhere the machine is a single node and placement requests do nothing.
+//
+
+#ifndef UNTITLED2_NUMA_H
+#define UNTITLED2_NUMA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class Numa {
+public:
+    struct Node {
+        int id;                 // kernel node number; ids need not be contiguous
+        std::vector<int> cpus;  // CPUs of the node this process may run on
+    };
+
+private:
+    // Memory policy modes of mbind(2), as in <numaif.h>
+    static constexpr int kPreferred = 1;
+    static constexpr int kInterleave = 3;
+
+    // "0-3,8,10-11" -> 0 1 2 3 8 10 11
+    static std::vector<int> ParseList(const std::string& text) {
+        std::vector<int> values;
+        std::stringstream items(text);
+        std::string item;
+        while (std::getline(items, item, ',')) {
+            size_t dash = item.find('-');
+            try {
+                int first = std::stoi(item.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+                for (int value = first; value <= last; ++value) {
+                    values.push_back(value);
+                }
+            } catch (const std::exception&) {
+                // blank or malformed item: nothing to add
+            }
+        }
+        return values;
+    }
+
+    static std::string ReadLine(const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    static std::vector<Node> ReadTopology() {
+        std::vector<Node> nodes;
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        for (int id : ParseList(ReadLine("/sys/devices/system/node/online"))) {
+            Node node{id, {}};
+            for (int cpu : ParseList(ReadLine("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist"))) {
+                if (!have_mask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) {
+                    node.cpus.push_back(cpu);
+                }
+            }
+            if (!node.cpus.empty()) {
+                nodes.push_back(std::move(node));
+            }
+        }
+#endif
+        if (nodes.empty()) {
+            Node node{0, {}};
+            for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+                node.cpus.push_back(static_cast<int>(cpu));
+            }
+            nodes.push_back(std::move(node));
+        }
+        return nodes;
+    }
+
+#if defined(__linux__)
+    // Sets the policy of the pages covering [begin, begin + bytes). The range is
+    // widened to whole pages, which must all belong to one mapping.
+    static bool SetPolicy(void* begin, size_t bytes, int mode, const std::vector<int>& node_ids) {
+        if (bytes == 0 || node_ids.empty()) {
+            return true;
+        }
+        int max_id = *std::max_element(node_ids.begin(), node_ids.end());
+        constexpr size_t kBits = sizeof(unsigned long) * 8;
+        std::vector<unsigned long> mask(max_id / kBits + 1, 0);
+        for (int id : node_ids) {
+            mask[id / kBits] |= 1UL << (id % kBits);
+        }
+        auto page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        auto first = reinterpret_cast<uintptr_t>(begin) / page * page;
+        auto last = reinterpret_cast<uintptr_t>(begin) + bytes;
+        // The kernel reads one bit less than maxnode says
+        return syscall(SYS_mbind, first, last - first, mode, mask.data(), mask.size() * kBits + 1, 0) == 0;
+    }
+#endif
+
+public:
+    // Nodes that have CPUs this process may use, in node order. Read once; a
+    // machine without the sysfs tree is one node with hardware_concurrency() CPUs.
+    static const std::vector<Node>& Topology() {
+        static const std::vector<Node> nodes = ReadTopology();
+        return nodes;
+    }
+
+    // Pins the calling thread to one CPU. False if the system refused, in which
+    // case the thread keeps running wherever the scheduler puts it.
+    static bool PinThread(int cpu) {
+#if defined(_WIN32)
+        return cpu >= 0 && cpu < 64 && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << cpu) != 0;
+#elif defined(__linux__)
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    // Page policies for memory that has not been touched yet; pages that already
+    // exist stay where they are. Failures only cost speed and are reported as false.
+
+    // Spreads the pages round-robin over all nodes
+    static bool Interleave(void* begin, size_t bytes) {
+#if defined(__linux__)
+        std::vector<int> ids;
+        for (const Node& node : Topology()) {
+            ids.push_back(node.id);
+        }
+        return ids.size() < 2 || SetPolicy(begin, bytes, kInterleave, ids);
+#else
+        (void)begin;
+        (void)bytes;
+        return false;
+#endif
+    }
+
+    // Puts the pages on one node while it has free memory, elsewhere after that
+    static bool Prefer(void* begin, size_t bytes, int node) {
+#if defined(__linux__)
+        return Topology().size() < 2 || SetPolicy(begin, bytes, kPreferred, {node});
+#else
+        (void)begin;
+        (void)bytes;
+        (void)node;
+        return false;
+#endif
+    }
+
+    // Node holding the page at `address`; -1 if unknown or the page was never touched
+    static int NodeOf(const void* address) {
+#if defined(__linux__)
+        void* page = const_cast<void*>(address);
+        int status = -1;
+        if (syscall(SYS_move_pages, 0, 1UL, &page, nullptr, &status, 0) != 0) {
+            return -1;
+        }
+        return status < 0 ? -1 : status;
+#else
+        (void)address;
+        return -1;
+#endif
+    }
+
+    // A fixed set of worker threads, each pinned to its own CPU while CPUs last.
+    // Workers fill the nodes in turn: the first size() / nodes go to the first
+    // node, the next ones to the second, so consecutive workers share a node.
+    class Workers {
+    private:
+        std::vector<int> cpus_;
+        std::vector<int> nodes_;
+
+    public:
+        // `threads` workers, 0 for one per CPU
+        explicit Workers(int threads = 0) {
+            const auto& topology = Topology();
+            if (threads <= 0) {
+                threads = 0;
+                for (const Node& node : topology) {
+                    threads += static_cast<int>(node.cpus.size());
+                }
+            }
+            size_t count = topology.size();
+            for (int w = 0; w < threads; ++w) {
+                size_t index = static_cast<size_t>(w) * count / threads;
+                // Position of this worker among the ones placed on the same node
+                size_t first = (index * threads + count - 1) / count;
+                const Node& node = topology[index];
+                cpus_.push_back(node.cpus[(w - first) % node.cpus.size()]);
+                nodes_.push_back(node.id);
+            }
+        }
+
+        [[nodiscard]] int size() const {
+            return static_cast<int>(cpus_.size());
+        }
+
+        [[nodiscard]] int cpu(int worker) const {
+            return cpus_[worker];
+        }
+
+        [[nodiscard]] int node(int worker) const {
+            return nodes_[worker];
+        }
+
+        // Runs work(w) for every worker w on a new thread pinned to cpu(w); the
+        // calling thread only waits. The first exception of a worker is rethrown.
+        template <typename Work>
+        void Run(Work work) const {
+            std::vector<std::exception_ptr> errors(cpus_.size());
+            std::vector<std::thread> threads;
+            threads.reserve(cpus_.size());
+            for (int w = 0; w < size(); ++w) {
+                threads.emplace_back([&, w] {
+                    try {
+                        PinThread(cpus_[w]);
+                        work(w);
+                    } catch (...) {
+                        errors[w] = std::current_exception();
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            for (const auto& error : errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+    };
+};
+
+#endif //UNTITLED2_NUMA_H
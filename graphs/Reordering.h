@@ -0,0 +1,95 @@
+//
+// Vertex orderings that improve memory locality of traversals over CSR rows.
+// Every function returns `order` with order[k] = vertex placed at position k (1..n),
+// order[0] unused.
+//
+
+#ifndef UNTITLED2_REORDERING_H
+#define UNTITLED2_REORDERING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+class Reordering {
+private:
+    static int Degree(const size_t* offsets, int v) {
+        return static_cast<int>(offsets[v + 1] - offsets[v]);
+    }
+
+    // Appends the vertices reachable from `start` in BFS order. With by_degree the
+    // neighbours of each vertex are enqueued from the lowest degree up (Cuthill–McKee).
+    static void Bfs(const size_t* offsets, const int* neighbors, int start, bool by_degree,
+                    std::vector<char>& visited, std::vector<int>& order) {
+        size_t head = order.size();
+        order.push_back(start);
+        visited[start] = 1;
+        while (head < order.size()) {
+            int u = order[head++];
+            size_t first = order.size();
+            for (size_t i = offsets[u]; i < offsets[u + 1]; ++i) {
+                int v = neighbors[i];
+                if (!visited[v]) {
+                    visited[v] = 1;
+                    order.push_back(v);
+                }
+            }
+            if (by_degree) {
+                std::stable_sort(order.begin() + first, order.end(), [offsets](int a, int b) {
+                    return Degree(offsets, a) < Degree(offsets, b);
+                });
+            }
+        }
+    }
+
+public:
+    // Highest degree first, ties keep the current numbering
+    static std::vector<int> ByDegree(const size_t* offsets, int n) {
+        std::vector<int> order(n + 1, 0);
+        for (int v = 1; v <= n; ++v) {
+            order[v] = v;
+        }
+        std::stable_sort(order.begin() + 1, order.end(), [offsets](int a, int b) {
+            return Degree(offsets, a) > Degree(offsets, b);
+        });
+        return order;
+    }
+
+    // Breadth-first order, restarting from the lowest unvisited vertex
+    static std::vector<int> ByBfs(const size_t* offsets, const int* neighbors, int n) {
+        std::vector<char> visited(n + 1, 0);
+        std::vector<int> order{0};
+        order.reserve(n + 1);
+        for (int v = 1; v <= n; ++v) {
+            if (!visited[v]) {
+                Bfs(offsets, neighbors, v, false, visited, order);
+            }
+        }
+        return order;
+    }
+
+    // Reverse Cuthill–McKee: every component is started from one of its
+    // lowest-degree vertices, then the whole sequence is reversed. Directed
+    // graphs are walked along out-arcs only.
+    static std::vector<int> ReverseCuthillMcKee(const size_t* offsets, const int* neighbors, int n) {
+        std::vector<int> starts(n);
+        for (int v = 1; v <= n; ++v) {
+            starts[v - 1] = v;
+        }
+        std::stable_sort(starts.begin(), starts.end(), [offsets](int a, int b) {
+            return Degree(offsets, a) < Degree(offsets, b);
+        });
+        std::vector<char> visited(n + 1, 0);
+        std::vector<int> order{0};
+        order.reserve(n + 1);
+        for (int v : starts) {
+            if (!visited[v]) {
+                Bfs(offsets, neighbors, v, true, visited, order);
+            }
+        }
+        std::reverse(order.begin() + 1, order.end());
+        return order;
+    }
+};
+
+#endif //UNTITLED2_REORDERING_H
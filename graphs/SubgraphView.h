@@ -0,0 +1,428 @@
+//
+// A subgraph of a BasicGraph that reads the graph's own rows. The view is given
+// a vertex mask, an arc filter, or both; the kept vertices are renumbered
+// 1..size() in their original order, and the parent's rows are filtered and
+// renumbered while they are traversed. Nothing but the two vertex maps and the
+// degrees is stored, so a view costs O(V) memory whatever the number of edges.
+//
+// The view has the read-only interface the finder classes use (size, neighbors,
+// in_neighbors, undirected_neighbors, prefetch, degree, weight, edge ids, external ids),
+// so any finder templated on the graph type runs on it unchanged. Edge ids are
+// the parent's: an EdgeMap made for the view is indexed like one for the parent.
+//
+// The view is valid while the parent is alive and unchanged.
+//
+
+#ifndef UNTITLED2_SUBGRAPHVIEW_H
+#define UNTITLED2_SUBGRAPHVIEW_H
+
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include "BitMatrix.h"
+
+template <typename G>
+class SubgraphView {
+public:
+    using Traits = typename G::Traits;
+    using weight_type = typename G::weight_type;
+    using distance_type = typename G::distance_type;
+    using Neighbor = typename G::Neighbor;
+
+    // Decides whether arc (u, v) of the parent is kept; u and v are parent vertices
+    using ArcFilter = std::function<bool(int u, int v, weight_type weight)>;
+
+    static constexpr size_t kNoEdge = G::kNoEdge;
+
+    using Rows = typename G::Rows;
+    static constexpr Rows OUT_ROWS = G::OUT_ROWS;
+    static constexpr Rows IN_ROWS = G::IN_ROWS;
+    static constexpr Rows UNDIRECTED_ROWS = G::UNDIRECTED_ROWS;
+
+private:
+    // Which of the parent's rows a NeighborRange walks
+    enum Direction { OUT, IN, EITHER };
+
+    const G* parent_;
+    ArcFilter filter_;
+    int size_ = 0;
+    std::vector<int> vertices_;  // local -> parent, [0] unused
+    std::vector<int> local_;     // parent -> local, 0 for dropped vertices
+    std::vector<int> degrees_;
+    size_t arc_count_ = 0;
+    size_t self_loops_ = 0;
+    bool is_directed_ = false;
+
+public:
+    // Kept neighbors of one vertex, in the parent's order
+    class NeighborRange {
+        using Base = typename G::NeighborRange;
+        using BaseIterator = typename Base::iterator;
+
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Neighbor;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Neighbor;
+
+            iterator(const SubgraphView* view, int row, Direction direction, BaseIterator it, BaseIterator end)
+                    : view_(view), row_(row), direction_(direction), it_(it), end_(end) {
+                Skip();
+            }
+
+            Neighbor operator*() const {
+                Neighbor neighbor = *it_;
+                if (direction_ == EITHER && view_->filter_ && !view_->KeepsArc(row_, neighbor.vertex)) {
+                    // Only the arc into the row is kept, its weight is the one to report
+                    neighbor.weight = view_->parent_->weight(neighbor.vertex, row_);
+                }
+                neighbor.vertex = view_->local_[neighbor.vertex];
+                return neighbor;
+            }
+            iterator& operator++() {
+                ++it_;
+                Skip();
+                return *this;
+            }
+            iterator operator++(int) {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==(const iterator& other) const { return it_ == other.it_; }
+            bool operator!=(const iterator& other) const { return it_ != other.it_; }
+
+        private:
+            void Skip() {
+                while (it_ != end_ && !view_->Keeps(row_, *it_, direction_)) {
+                    ++it_;
+                }
+            }
+
+            const SubgraphView* view_;
+            int row_;
+            Direction direction_;
+            BaseIterator it_;
+            BaseIterator end_;
+        };
+
+        NeighborRange(const SubgraphView* view, int row, Direction direction, Base base)
+                : view_(view), row_(row), direction_(direction), base_(base) {}
+
+        [[nodiscard]] iterator begin() const { return {view_, row_, direction_, base_.begin(), base_.end()}; }
+        [[nodiscard]] iterator end() const { return {view_, row_, direction_, base_.end(), base_.end()}; }
+        [[nodiscard]] bool empty() const { return begin() == end(); }
+
+    private:
+        const SubgraphView* view_;
+        int row_;
+        Direction direction_;
+        Base base_;
+    };
+
+    // Ids of the kept arcs of one vertex
+    class EdgeIdRange {
+        using Base = typename G::EdgeIdRange;
+        using BaseIterator = typename Base::iterator;
+
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = size_t;
+
+            iterator(const SubgraphView* view, int row, BaseIterator it, BaseIterator end)
+                    : view_(view), row_(row), it_(it), end_(end) {
+                Skip();
+            }
+
+            size_t operator*() const { return *it_; }
+            iterator& operator++() {
+                ++it_;
+                Skip();
+                return *this;
+            }
+            iterator operator++(int) {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==(const iterator& other) const { return it_ == other.it_; }
+            bool operator!=(const iterator& other) const { return it_ != other.it_; }
+
+        private:
+            void Skip() {
+                while (it_ != end_ && !view_->KeepsEdge(row_, *it_)) {
+                    ++it_;
+                }
+            }
+
+            const SubgraphView* view_;
+            int row_;
+            BaseIterator it_;
+            BaseIterator end_;
+        };
+
+        EdgeIdRange(const SubgraphView* view, int row, Base base) : view_(view), row_(row), base_(base) {}
+
+        [[nodiscard]] iterator begin() const { return {view_, row_, base_.begin(), base_.end()}; }
+        [[nodiscard]] iterator end() const { return {view_, row_, base_.end(), base_.end()}; }
+        [[nodiscard]] bool empty() const { return begin() == end(); }
+
+    private:
+        const SubgraphView* view_;
+        int row_;
+        Base base_;
+    };
+
+private:
+    void CheckVertex(int v) const {
+        if (v < 1 || v > size_) {
+            throw std::out_of_range("Vertex out of range");
+        }
+    }
+
+    // Arc (u, v) between parent vertices passes the filter; both ends are kept
+    [[nodiscard]] bool PassesFilter(int u, int v, weight_type weight) const {
+        return !filter_ || filter_(u, v, weight);
+    }
+
+    // The parent has arc (u, v) and the view keeps it; both ends are kept
+    [[nodiscard]] bool KeepsArc(int u, int v) const {
+        weight_type weight = parent_->weight(u, v);
+        return weight != 0 && PassesFilter(u, v, weight);
+    }
+
+    // Entry of parent row `row` in the given direction is part of the view
+    [[nodiscard]] bool Keeps(int row, const Neighbor& neighbor, Direction direction) const {
+        if (local_[neighbor.vertex] == 0) {
+            return false;
+        }
+        if (!filter_) {
+            return true;
+        }
+        switch (direction) {
+            case OUT:
+                return filter_(row, neighbor.vertex, neighbor.weight);
+            case IN:
+                return filter_(neighbor.vertex, row, neighbor.weight);
+            default:
+                return KeepsArc(row, neighbor.vertex) || KeepsArc(neighbor.vertex, row);
+        }
+    }
+
+    [[nodiscard]] bool KeepsEdge(int row, size_t id) const {
+        int target = parent_->edge_target(id);
+        return local_[target] != 0 && PassesFilter(row, target, parent_->edge_weight(id));
+    }
+
+    void Build(const std::vector<bool>& mask) {
+        int n = parent_->size();
+        local_.assign(n + 1, 0);
+        vertices_.assign(1, 0);
+        for (int v = 1; v <= n; ++v) {
+            if (v < static_cast<int>(mask.size()) && mask[v]) {
+                vertices_.push_back(v);
+                local_[v] = static_cast<int>(vertices_.size()) - 1;
+            }
+        }
+        size_ = static_cast<int>(vertices_.size()) - 1;
+
+        // Directed if the parent is, or if the filter keeps an arc but not its reverse
+        is_directed_ = parent_->is_directed();
+        bool check_symmetry = !is_directed_ && filter_;
+        degrees_.assign(size_ + 1, 0);
+        for (int v = 1; v <= size_; ++v) {
+            int u = vertices_[v];
+            for (const Neighbor& neighbor : parent_->neighbors(u)) {
+                if (!Keeps(u, neighbor, OUT)) {
+                    continue;
+                }
+                ++degrees_[v];
+                if (neighbor.vertex == u) {
+                    ++self_loops_;
+                } else if (check_symmetry && !KeepsArc(neighbor.vertex, u)) {
+                    is_directed_ = true;
+                    check_symmetry = false;
+                }
+            }
+            arc_count_ += degrees_[v];
+        }
+    }
+
+    static std::vector<bool> MaskOf(const G& graph, const std::vector<int>& vertices) {
+        std::vector<bool> mask(graph.size() + 1, false);
+        for (int v : vertices) {
+            if (v < 1 || v > graph.size()) {
+                throw std::out_of_range("Vertex out of range");
+            }
+            mask[v] = true;
+        }
+        return mask;
+    }
+
+public:
+    // Subgraph induced by the vertices v with mask[v] set (mask[0] is ignored),
+    // keeping only the arcs that pass `filter` if one is given
+    SubgraphView(const G& graph, const std::vector<bool>& mask, ArcFilter filter = nullptr)
+            : parent_(&graph), filter_(std::move(filter)) {
+        Build(mask);
+    }
+
+    // Subgraph induced by the listed vertices; their order does not matter
+    SubgraphView(const G& graph, const std::vector<int>& vertices, ArcFilter filter = nullptr)
+            : SubgraphView(graph, MaskOf(graph, vertices), std::move(filter)) {}
+
+    // Every vertex, the arcs that pass `filter`
+    SubgraphView(const G& graph, ArcFilter filter)
+            : SubgraphView(graph, std::vector<bool>(graph.size() + 1, true), std::move(filter)) {}
+
+    [[nodiscard]] const G& parent() const {
+        return *parent_;
+    }
+
+    [[nodiscard]] int size() const {
+        return size_;
+    }
+
+    // Vertex of the parent shown as v
+    [[nodiscard]] int parent_vertex(int v) const {
+        CheckVertex(v);
+        return vertices_[v];
+    }
+
+    // Number of parent vertex v in the view, 0 if it was dropped
+    [[nodiscard]] int local_vertex(int v) const {
+        if (v < 1 || v > parent_->size()) {
+            throw std::out_of_range("Vertex out of range");
+        }
+        return local_[v];
+    }
+
+    [[nodiscard]] bool has_external_ids() const {
+        return parent_->has_external_ids() || size_ != parent_->size();
+    }
+
+    // Id of v in the parent's input file
+    [[nodiscard]] int64_t external_id(int v) const {
+        return parent_->external_id(parent_vertex(v));
+    }
+
+    [[nodiscard]] int internal_id(int64_t id) const {
+        int v = local_[parent_->internal_id(id)];
+        if (v == 0) {
+            throw std::out_of_range("Unknown vertex id");
+        }
+        return v;
+    }
+
+    [[nodiscard]] weight_type weight(int u, int v) const {
+        int from = parent_vertex(u);
+        int to = parent_vertex(v);
+        weight_type weight = parent_->weight(from, to);
+        return weight != 0 && PassesFilter(from, to, weight) ? weight : 0;
+    }
+
+    bool is_edge(int u, int v) const {
+        return weight(u, v) != 0;
+    }
+
+    // The parent's bit matrix is numbered the parent's way; finders fall back to rows
+    [[nodiscard]] const BitMatrix* adjacency_bits() const {
+        return nullptr;
+    }
+
+    [[nodiscard]] NeighborRange neighbors(int v) const {
+        int u = parent_vertex(v);
+        return NeighborRange(this, u, OUT, parent_->neighbors(u));
+    }
+
+    [[nodiscard]] int degree(int v) const {
+        CheckVertex(v);
+        return degrees_[v];
+    }
+
+    // Reads in the parent's row, which the view filters as it is traversed
+    void prefetch(int v, Rows rows = OUT_ROWS) const {
+        parent_->prefetch(parent_vertex(v), rows);
+    }
+
+    [[nodiscard]] NeighborRange in_neighbors(int v) const {
+        int u = parent_vertex(v);
+        return NeighborRange(this, u, IN, parent_->in_neighbors(u));
+    }
+
+    // O(in-degree in the parent)
+    [[nodiscard]] int in_degree(int v) const {
+        if (!is_directed_) {
+            return degree(v);
+        }
+        NeighborRange range = in_neighbors(v);
+        return static_cast<int>(std::distance(range.begin(), range.end()));
+    }
+
+    [[nodiscard]] NeighborRange undirected_neighbors(int v) const {
+        int u = parent_vertex(v);
+        return NeighborRange(this, u, EITHER, parent_->undirected_neighbors(u));
+    }
+
+    // Edge ids, shared with the parent: every id is below edge_id_bound()
+    [[nodiscard]] size_t edge_id_bound() const {
+        return parent_->edge_id_bound();
+    }
+
+    [[nodiscard]] EdgeIdRange out_edges(int v) const {
+        int u = parent_vertex(v);
+        return EdgeIdRange(this, u, parent_->out_edges(u));
+    }
+
+    [[nodiscard]] size_t edge_id(int u, int v) const {
+        int from = parent_vertex(u);
+        int to = parent_vertex(v);
+        size_t id = parent_->edge_id(from, to);
+        return id != kNoEdge && PassesFilter(from, to, parent_->edge_weight(id)) ? id : kNoEdge;
+    }
+
+    // Valid for the ids out_edges() yields
+    [[nodiscard]] int edge_target(size_t id) const {
+        return local_[parent_->edge_target(id)];
+    }
+
+    [[nodiscard]] weight_type edge_weight(size_t id) const {
+        return parent_->edge_weight(id);
+    }
+
+    [[nodiscard]] size_t reverse_edge(size_t id) const {
+        size_t back = parent_->reverse_edge(id);
+        if (back == kNoEdge || !filter_) {
+            return back;
+        }
+        int from = parent_->edge_target(id);
+        int to = parent_->edge_target(back);
+        return PassesFilter(from, to, parent_->edge_weight(back)) ? back : kNoEdge;
+    }
+
+    [[nodiscard]] bool is_directed() const {
+        return is_directed_;
+    }
+
+    [[nodiscard]] size_t arc_count() const {
+        return arc_count_;
+    }
+
+    [[nodiscard]] size_t edge_count() const {
+        return is_directed_ ? arc_count_ : (arc_count_ + self_loops_) / 2;
+    }
+};
+
+#endif //UNTITLED2_SUBGRAPHVIEW_H
@@ -0,0 +1,87 @@
+//
+// Compile-time description of an edge weight type for BasicGraph<W>.
+//
+
+#ifndef UNTITLED2_WEIGHTTRAITS_H
+#define UNTITLED2_WEIGHTTRAITS_H
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Tag for graphs that only record whether an edge exists
+struct Unweighted {};
+
+template <typename W>
+struct WeightTraits {
+    static_assert(std::is_arithmetic_v<W>, "Weight must be an arithmetic type or Unweighted");
+
+    using value_type = W;
+    using parse_type = W;
+    // Path lengths over integer weights are summed in 64 bits so they cannot wrap
+    using distance_type = std::conditional_t<std::is_floating_point_v<W>, double, int64_t>;
+
+    static constexpr bool kStored = true;
+    // Recorded in BINARY snapshots so a file is never read back with the wrong type
+    static constexpr uint32_t kKind =
+            (std::is_floating_point_v<W> ? 0x200u : std::is_signed_v<W> ? 0x100u : 0u) | sizeof(W);
+
+    static constexpr value_type from_parsed(parse_type weight) {
+        return weight;
+    }
+
+    static constexpr distance_type infinity() {
+        if constexpr (std::is_floating_point_v<distance_type>) {
+            return std::numeric_limits<distance_type>::infinity();
+        } else {
+            return std::numeric_limits<distance_type>::max();
+        }
+    }
+
+    // a + b that saturates at infinity() instead of overflowing
+    static constexpr distance_type add(distance_type a, distance_type b) {
+        if constexpr (std::is_floating_point_v<distance_type>) {
+            return a + b;
+        } else {
+            if (a == infinity() || b == infinity()) {
+                return infinity();
+            }
+            if (b > 0 && a > infinity() - b) {
+                return infinity();
+            }
+            if (b < 0 && a < std::numeric_limits<distance_type>::min() - b) {
+                return std::numeric_limits<distance_type>::min();
+            }
+            return a + b;
+        }
+    }
+};
+
+// No weight array at all: every edge weighs 1 and a dense matrix is one bit per cell
+template <>
+struct WeightTraits<Unweighted> {
+    using value_type = int;
+    // Weighted inputs are accepted, only "zero" versus "non-zero" is kept
+    using parse_type = double;
+    using distance_type = int;
+
+    static constexpr bool kStored = false;
+    static constexpr uint32_t kKind = 0;
+
+    static constexpr value_type from_parsed(parse_type weight) {
+        return weight != 0 ? 1 : 0;
+    }
+
+    static constexpr distance_type infinity() {
+        return std::numeric_limits<distance_type>::max();
+    }
+
+    static constexpr distance_type add(distance_type a, distance_type b) {
+        if (a == infinity() || b == infinity() || a > infinity() - b) {
+            return infinity();
+        }
+        return a + b;
+    }
+};
+
+#endif //UNTITLED2_WEIGHTTRAITS_H
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Graph.h"
+
+// Usage: bench_bitset [matrix_file [repeats]]
+// Compares matrix memory and BFS / triangle counting on CSR rows against the
+// word-parallel versions on BITSET rows. Checksums must match.
+
+template <typename Run>
+double measure_ms(int repeats, Run run, long long& checksum) {
+    checksum = run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        if (run() != checksum) {
+            throw std::runtime_error("Inconsistent benchmark results");
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+}
+
+// Sum over every source of the BFS depths of all reached vertices
+long long bfs_queue(const Graph& graph) {
+    int n = graph.size();
+    std::vector<int> depth(n + 1);
+    std::vector<int> queue(n);
+    long long total = 0;
+    for (int s = 1; s <= n; ++s) {
+        std::fill(depth.begin(), depth.end(), -1);
+        size_t head = 0, tail = 0;
+        queue[tail++] = s;
+        depth[s] = 0;
+        while (head < tail) {
+            int u = queue[head++];
+            total += depth[u];
+            for (auto [v, weight] : graph.neighbors(u)) {
+                if (depth[v] < 0) {
+                    depth[v] = depth[u] + 1;
+                    queue[tail++] = v;
+                }
+            }
+        }
+    }
+    return total;
+}
+
+// Level-synchronous BFS: the next frontier is the union of the frontier's rows
+// minus the visited set, all in whole words
+long long bfs_frontier(const Graph& graph) {
+    const BitMatrix& bits = *graph.adjacency_bits();
+    size_t words = bits.words_per_row();
+    std::vector<uint64_t> visited(words), frontier(words), next(words);
+    long long total = 0;
+    for (int s = 1; s <= graph.size(); ++s) {
+        std::fill(visited.begin(), visited.end(), 0);
+        std::fill(frontier.begin(), frontier.end(), 0);
+        visited[s / 64] = frontier[s / 64] = uint64_t{1} << (s % 64);
+        for (long long depth = 1;; ++depth) {
+            std::fill(next.begin(), next.end(), 0);
+            BitMatrix::ForEachBit(frontier.data(), words, [&](size_t u) {
+                BitMatrix::Unite(next.data(), next.data(), bits.row(u), words);
+            });
+            BitMatrix::Subtract(next.data(), next.data(), visited.data(), words);
+            size_t found = BitMatrix::Count(next.data(), words);
+            if (found == 0) {
+                break;
+            }
+            total += depth * static_cast<long long>(found);
+            BitMatrix::Unite(visited.data(), visited.data(), next.data(), words);
+            frontier.swap(next);
+        }
+    }
+    return total;
+}
+
+// Sum over arcs (u, v), u < v, of |N(u) & N(v)|: three times the triangle
+// count of an undirected graph
+long long triangles_merge(const Graph& graph) {
+    long long total = 0;
+    for (int u = 1; u <= graph.size(); ++u) {
+        auto row_u = graph.neighbors(u);
+        for (auto [v, weight] : row_u) {
+            if (v <= u) continue;
+            auto a = row_u.begin(), a_end = row_u.end();
+            auto row_v = graph.neighbors(v);
+            auto b = row_v.begin(), b_end = row_v.end();
+            while (a != a_end && b != b_end) {
+                int x = (*a).vertex, y = (*b).vertex;
+                if (x == y) {
+                    ++total;
+                    ++a;
+                    ++b;
+                } else if (x < y) {
+                    ++a;
+                } else {
+                    ++b;
+                }
+            }
+        }
+    }
+    return total;
+}
+
+long long triangles_bits(const Graph& graph) {
+    const BitMatrix& bits = *graph.adjacency_bits();
+    long long total = 0;
+    for (int u = 1; u <= graph.size(); ++u) {
+        for (auto [v, weight] : graph.neighbors(u)) {
+            if (v <= u) continue;
+            total += static_cast<long long>(BitMatrix::IntersectionCount(bits.row(u), bits.row(v), bits.words_per_row()));
+        }
+    }
+    return total;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string path = argc > 1 ? argv[1] : "matrix_t14_010.txt";
+        int repeats = argc > 2 ? std::stoi(argv[2]) : 3;
+
+        Graph dense(path, Graph::MATRIX, Graph::DENSE);
+        Graph bitset(path, Graph::MATRIX, Graph::BITSET);
+        size_t cells = static_cast<size_t>(dense.size() + 1) * (dense.size() + 1);
+        std::cout << "Vertices: " << dense.size() << "\n";
+        std::cout << "Matrix bytes: DENSE " << cells * sizeof(Graph::weight_type)
+                  << ", BITSET " << bitset.adjacency_bits()->bytes() << "\n";
+
+        long long queue_check, frontier_check, merge_check, bits_check;
+        std::cout << std::fixed << std::setprecision(2);
+        double queue_ms = measure_ms(repeats, [&] { return bfs_queue(dense); }, queue_check);
+        double frontier_ms = measure_ms(repeats, [&] { return bfs_frontier(bitset); }, frontier_check);
+        double merge_ms = measure_ms(repeats, [&] { return triangles_merge(dense); }, merge_check);
+        double bits_ms = measure_ms(repeats, [&] { return triangles_bits(bitset); }, bits_check);
+        if (queue_check != frontier_check || merge_check != bits_check) {
+            throw std::runtime_error("Bit-parallel results differ");
+        }
+        std::cout << "BFS from every vertex: queue " << queue_ms << " ms, bit frontier " << frontier_ms << " ms\n";
+        std::cout << "Triangles (" << bits_check / 3 << "): merge " << merge_ms << " ms, bit rows " << bits_ms << " ms\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Graph.h"
+#include "CompressedGraph.h"
+
+// Usage: bench_compressed [edges_file [sources]]
+// Bytes per edge and BFS throughput of the CSR rows against the compressed rows.
+
+using StructureGraph = BasicGraph<Unweighted>;
+using StructureCompressed = BasicCompressedGraph<Unweighted>;
+
+// BFS from the first `sources` vertices; returns the number of arcs scanned
+template <typename G>
+long long bfs_arcs(const G& graph, int sources, long long& reached) {
+    int n = graph.size();
+    std::vector<int> seen(n + 1, 0);
+    std::vector<int> queue(n);
+    long long arcs = 0;
+    reached = 0;
+    for (int s = 1; s <= sources && s <= n; ++s) {
+        size_t head = 0, tail = 0;
+        queue[tail++] = s;
+        seen[s] = s;
+        while (head < tail) {
+            int u = queue[head++];
+            for (auto [v, weight] : graph.neighbors(u)) {
+                ++arcs;
+                if (seen[v] != s) {
+                    seen[v] = s;
+                    queue[tail++] = v;
+                }
+            }
+        }
+        reached += static_cast<long long>(tail);
+    }
+    return arcs;
+}
+
+template <typename G>
+double measure_arcs_per_s(const G& graph, int sources, long long& reached) {
+    auto start = std::chrono::steady_clock::now();
+    long long arcs = bfs_arcs(graph, sources, reached);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return arcs / elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string path = argc > 1 ? argv[1] : "list_of_edges_t14_010.txt";
+        int sources = argc > 2 ? std::stoi(argv[2]) : 200;
+
+        StructureGraph graph(path, StructureGraph::EDGES_LIST, StructureGraph::CSR);
+        StructureCompressed compressed(graph);
+        double arcs = static_cast<double>(graph.arc_count());
+        double csr_bytes = arcs * sizeof(int) + (graph.size() + 2.0) * sizeof(size_t);
+
+        std::cout << "Vertices: " << graph.size() << ", arcs: " << graph.arc_count() << "\n";
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Bytes per arc: CSR " << csr_bytes / arcs
+                  << ", compressed " << compressed.bytes() / arcs
+                  << " (neighbour lists alone " << compressed.adjacency_bytes() / arcs << ")\n";
+
+        long long csr_reached, compressed_reached;
+        double csr_rate = measure_arcs_per_s(graph, sources, csr_reached);
+        double compressed_rate = measure_arcs_per_s(compressed, sources, compressed_reached);
+        if (csr_reached != compressed_reached) {
+            throw std::runtime_error("Compressed traversal differs");
+        }
+        std::cout << "BFS: CSR " << csr_rate / 1e6 << " M arcs/s, compressed "
+                  << compressed_rate / 1e6 << " M arcs/s\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "Graph.h"
+#include "MappedFile.h"
+
+// Usage: bench_load [matrix_file edges_file adjacency_file [repeats]]
+double measure_mb_per_s(const std::string& path, Graph::FileType type, int repeats,
+                        Graph::VertexIds ids = Graph::INDEX_IDS) {
+    double megabytes = MappedFile(path).size() / (1024.0 * 1024.0);
+    Graph warmup(path, type, Graph::CSR, Graph::DETECT, ids);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = 0;
+    for (int i = 0; i < repeats; ++i) {
+        Graph graph(path, type, Graph::CSR, Graph::DETECT, ids);
+        checksum += graph.size();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (checksum != static_cast<size_t>(warmup.size()) * repeats) {
+        throw std::runtime_error("Inconsistent load results");
+    }
+    return megabytes * repeats / elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string matrix = argc > 3 ? argv[1] : "matrix_t14_010.txt";
+        std::string edges = argc > 3 ? argv[2] : "list_of_edges_t14_010.txt";
+        std::string adjacency = argc > 3 ? argv[3] : "list_of_adjacency_t13_012.txt";
+        int repeats = argc > 4 ? std::stoi(argv[4]) : 10;
+
+        std::cout << "Threads: " << std::thread::hardware_concurrency() << "\n";
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "MATRIX:         " << measure_mb_per_s(matrix, Graph::MATRIX, repeats) << " MB/s\n";
+        std::cout << "EDGES_LIST:     " << measure_mb_per_s(edges, Graph::EDGES_LIST, repeats) << " MB/s\n";
+        std::cout << "  EXTERNAL_IDS: "
+                  << measure_mb_per_s(edges, Graph::EDGES_LIST, repeats, Graph::EXTERNAL_IDS) << " MB/s\n";
+        std::cout << "ADJACENCY_LIST: " << measure_mb_per_s(adjacency, Graph::ADJACENCY_LIST, repeats) << " MB/s\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
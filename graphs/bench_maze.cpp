@@ -0,0 +1,183 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include "map.h"
+#include "BitMatrix.h"
+#include "GridBfs.h"
+#include "Generators.h"
+
+// Usage: bench_maze [maze_file [rows cols [blocked [seed]]]]
+// Shortest paths on the maze file (the query of sixth.cpp, then across its
+// largest component) and on a generated rows x cols grid with a `blocked` share
+// of walls, by the hash-map BFS sixth.cpp used to have and by GridBfs in both
+// modes. Reports cells taken off the queue per second, and how many fewer cells
+// the bidirectional search expands. The hash-map BFS is skipped above
+// kReferenceCells. Apart from the sixth.cpp query, both ends of every search lie
+// in the component that holds over half the passable cells, so every search
+// finds a path and the rates are for whole searches.
+
+using Cell = std::pair<int, int>;
+
+const size_t kReferenceCells = 20000000;
+const size_t kMaxStarts = 1000;
+
+// The former find_path of sixth.cpp; counts the cells it takes off the queue
+std::vector<Cell> reference_path(const Map& map, Cell start, Cell end, size_t& expanded) {
+    std::queue<Cell> q;
+    std::unordered_map<int, std::unordered_map<int, Cell>> parent;
+    expanded = 0;
+
+    q.push(start);
+    parent[start.first][start.second] = {-1, -1};
+    while (!q.empty()) {
+        auto current = q.front();
+        q.pop();
+        ++expanded;
+        if (current == end) {
+            std::vector<Cell> path;
+            while (current.first != -1) {
+                path.push_back(current);
+                current = parent[current.first][current.second];
+            }
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+        for (const auto& neighbor : map.neighbors(current.first, current.second)) {
+            if (!parent[neighbor.first].count(neighbor.second)) {
+                parent[neighbor.first][neighbor.second] = current;
+                q.push(neighbor);
+            }
+        }
+    }
+    return {};
+}
+
+template <typename Run>
+double measure_s(Run run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void report(const std::string& name, size_t path_size, size_t expanded, double seconds) {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right
+              << std::setw(10) << path_size << std::setw(14) << expanded
+              << std::setw(12) << seconds * 1e3 << std::setw(14) << expanded / seconds / 1e6 << "\n";
+}
+
+void query(const Map& map, Cell start, Cell end) {
+    std::cout << "(" << start.first << ", " << start.second << ") -> (" << end.first << ", " << end.second << ")\n";
+    std::cout << "  " << std::left << std::setw(10) << "BFS" << std::right << std::setw(10) << "Path"
+              << std::setw(14) << "Expanded" << std::setw(12) << "Time, ms" << std::setw(14) << "M cells/s" << "\n";
+    GridBfs bfs(map);
+    std::vector<Cell> path;
+    double seconds = measure_s([&] { path = bfs.find_path(start, end); });
+    if (map.cell_count() <= kReferenceCells) {
+        size_t expanded = 0;
+        std::vector<Cell> expected;
+        double reference_seconds = measure_s([&] { expected = reference_path(map, start, end, expanded); });
+        if (path != expected) {
+            throw std::runtime_error("GridBfs path differs");
+        }
+        report("hash map", expected.size(), expanded, reference_seconds);
+    }
+    report("grid", path.size(), bfs.expanded(), seconds);
+    size_t forward_expanded = bfs.expanded();
+
+    std::vector<Cell> shortcut;
+    seconds = measure_s([&] { shortcut = bfs.find_path(start, end, GridBfs::BIDIRECTIONAL); });
+    if (shortcut.size() != path.size()) {
+        throw std::runtime_error("Bidirectional path has another length");
+    }
+    report("bidir", shortcut.size(), bfs.expanded(), seconds);
+    // Without a path the searches only show how fast the smaller side runs out
+    // of cells; that says nothing of point-to-point savings
+    if (path.empty()) {
+        std::cout << "  No path: the ends are not connected, no reduction to report\n";
+    } else if (bfs.expanded() > 0) {
+        std::cout << "  Bidirectional expands " << 100.0 * bfs.expanded() / forward_expanded << "% of the cells ("
+                  << static_cast<double>(forward_expanded) / bfs.expanded() << "x fewer)\n";
+    }
+}
+
+size_t passable_cells(const Map& map) {
+    size_t count = 0;
+    for (int i = 0; i < map.size().first; ++i) {
+        count += BitMatrix::Count(map.row(i), map.words_per_row());
+    }
+    return count;
+}
+
+// First passable cell in row-major order whose component holds over half the
+// passable cells, and the cell farthest from it. There is at most one such
+// component; afterwards bfs.reached() tells the cells that are in it. Gives up
+// after kMaxStarts searches, as on a grid too blocked to have such a component.
+std::pair<Cell, Cell> largest_component(const Map& map, GridBfs& bfs) {
+    size_t half = passable_cells(map) / 2;
+    size_t starts = 0;
+    for (size_t cell = 0; cell < map.cell_count() && starts < kMaxStarts; ++cell) {
+        Cell start = {map.cell_row(cell), map.cell_col(cell)};
+        if (!map(start.first, start.second)) {
+            continue;
+        }
+        ++starts;
+        Cell end = bfs.farthest(start);
+        if (bfs.expanded() > half) {
+            return {start, end};
+        }
+    }
+    throw std::runtime_error("No component holds half of the passable cells; try fewer blocked cells");
+}
+
+// First cell at or after (i, j) in row-major order that the last search of bfs reached
+Cell reached_from(const Map& map, const GridBfs& bfs, int i, int j) {
+    for (size_t cell = map.cell(i, j); cell < map.cell_count(); ++cell) {
+        Cell found = {map.cell_row(cell), map.cell_col(cell)};
+        if (bfs.reached(found)) {
+            return found;
+        }
+    }
+    throw std::runtime_error("No reached cell after (" + std::to_string(i) + ", " + std::to_string(j) + ")");
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string path = argc > 1 ? argv[1] : "maze_t6_007.txt";
+        int rows = argc > 3 ? std::stoi(argv[2]) : 10000;
+        int cols = argc > 3 ? std::stoi(argv[3]) : 10000;
+        double blocked = argc > 4 ? std::stod(argv[4]) : 0.3;
+        GeneratorOptions options;
+        options.seed = argc > 5 ? std::stoull(argv[5]) : 1;
+        std::cout << std::fixed << std::setprecision(2);
+
+        Map maze(path);
+        std::cout << path << ": " << maze.size().first << "x" << maze.size().second << "\n";
+        query(maze, {4361, 21}, {2571, 17});
+        GridBfs probe(maze);
+        auto [first, last] = largest_component(maze, probe);
+        query(maze, first, last);
+
+        auto start = std::chrono::steady_clock::now();
+        Map grid = Generators::Maze(rows, cols, blocked, options);
+        std::chrono::duration<double> generate_s = std::chrono::steady_clock::now() - start;
+        std::cout << "\nGenerated " << rows << "x" << cols << ", blocked " << blocked << ", in "
+                  << generate_s.count() * 1e3 << " ms\n";
+        GridBfs grid_probe(grid);
+        std::tie(first, last) = largest_component(grid, grid_probe);
+        query(grid, first, last);
+        // Both searches stay away from the borders here, where halving the radius pays most
+        query(grid, reached_from(grid, grid_probe, rows / 2, cols / 4),
+              reached_from(grid, grid_probe, rows / 2, cols / 4 * 3));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Graph.h"
+#include "Numa.h"
+
+// Usage: bench_numa [edges_file [threads [repeats]]]
+// Places the rows as loaded, by first touch, interleaved and partitioned, then runs
+// the same kernels on pinned workers. Worker w scans part w of vertex_ranges():
+// "local" reads its own part, "remote" the part of a worker on the next node.
+// "Gather" reads the degree of every neighbour, i.e. rows of all parts.
+
+struct Result {
+    double place_ms = 0;
+    double local_pages = -1;  // share of the neighbour pages on their worker's node
+    double local_gbs = 0;
+    double remote_gbs = 0;
+    double gather_arcs = 0;   // arcs per second
+    long long checksum = 0;   // the same for every placement
+};
+
+// Best of `repeats` runs of work(w) on all workers, in seconds
+template <typename Work>
+double best_seconds(const Numa::Workers& workers, int repeats, Work work) {
+    double best = 0;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        workers.Run(work);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (r == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+// Pages of the neighbour lists of each part that sit on the node of its worker
+double local_page_share(const Graph& graph, const Numa::Workers& workers, const std::vector<int>& ranges) {
+    const size_t page = 4096;
+    size_t known = 0;
+    size_t local = 0;
+    for (int w = 0; w < workers.size(); ++w) {
+        if (ranges[w] == ranges[w + 1]) {
+            continue;
+        }
+        const char* first = reinterpret_cast<const char*>(graph.neighbors(ranges[w]).data());
+        auto last_row = graph.neighbors(ranges[w + 1] - 1);
+        const char* last = reinterpret_cast<const char*>(last_row.data() + last_row.size());
+        for (const char* p = first; p < last; p += page) {
+            int node = Numa::NodeOf(p);
+            if (node >= 0) {
+                ++known;
+                local += node == workers.node(w);
+            }
+        }
+    }
+    return known ? 100.0 * local / known : -1;
+}
+
+Result run(const Graph& graph, const Numa::Workers& workers, int repeats) {
+    Result result;
+    int parts = workers.size();
+    std::vector<int> ranges = graph.vertex_ranges(parts);
+    result.local_pages = local_page_share(graph, workers, ranges);
+
+    // Consecutive workers share a node, so the part `shift` workers on is remote
+    int shift = 0;
+    while (shift < parts && workers.node(shift) == workers.node(0)) {
+        ++shift;
+    }
+    std::vector<long long> sink(parts, 0);
+    auto scan = [&](int w, int part) {
+        long long sum = 0;
+        for (int u = ranges[part]; u < ranges[part + 1]; ++u) {
+            for (auto [v, weight] : graph.neighbors(u)) {
+                sum += v + weight;
+            }
+        }
+        sink[w] += sum;
+    };
+    double bytes = graph.arc_count() * (sizeof(int) + sizeof(Graph::weight_type)) +
+                   (graph.size() + 2.0) * sizeof(size_t);
+    result.local_gbs = bytes / best_seconds(workers, repeats, [&](int w) { scan(w, w); }) / 1e9;
+    if (shift < parts) {
+        result.remote_gbs = bytes / best_seconds(workers, repeats, [&](int w) { scan(w, (w + shift) % parts); }) / 1e9;
+    }
+
+    double seconds = best_seconds(workers, repeats, [&](int w) {
+        long long sum = 0;
+        for (int u = ranges[w]; u < ranges[w + 1]; ++u) {
+            for (auto [v, weight] : graph.neighbors(u)) {
+                sum += graph.degree(v);
+            }
+        }
+        sink[w] += sum;
+    });
+    result.gather_arcs = graph.arc_count() / seconds;
+    for (long long sum : sink) {
+        result.checksum += sum;
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string path = argc > 1 ? argv[1] : "list_of_edges_t14_010.txt";
+        int threads = argc > 2 ? std::stoi(argv[2]) : 0;
+        int repeats = argc > 3 ? std::stoi(argv[3]) : 5;
+
+        Graph graph(path, Graph::EDGES_LIST, Graph::CSR);
+        Numa::Workers workers(threads);
+        std::cout << "Vertices: " << graph.size() << ", arcs: " << graph.arc_count()
+                  << ", workers: " << workers.size() << "\n";
+        for (const auto& node : Numa::Topology()) {
+            std::cout << "Node " << node.id << ": " << node.cpus.size() << " CPUs, workers";
+            for (int w = 0; w < workers.size(); ++w) {
+                if (workers.node(w) == node.id) {
+                    std::cout << " " << w << "@" << workers.cpu(w);
+                }
+            }
+            std::cout << "\n";
+        }
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::left << std::setw(14) << "Placement" << std::right
+                  << std::setw(12) << "Place, ms" << std::setw(14) << "Local pages"
+                  << std::setw(14) << "Local GB/s" << std::setw(14) << "Remote GB/s"
+                  << std::setw(18) << "Gather M arcs/s" << "\n";
+        auto report = [&](const std::string& name, const Result& result) {
+            std::cout << std::left << std::setw(14) << name << std::right << std::setw(12) << result.place_ms;
+            if (result.local_pages < 0) {
+                std::cout << std::setw(14) << "-";
+            } else {
+                std::cout << std::setw(13) << result.local_pages << "%";
+            }
+            std::cout << std::setw(14) << result.local_gbs;
+            if (result.remote_gbs == 0) {
+                std::cout << std::setw(14) << "-";
+            } else {
+                std::cout << std::setw(14) << result.remote_gbs;
+            }
+            std::cout << std::setw(18) << result.gather_arcs / 1e6 << "\n";
+        };
+
+        Result loaded = run(graph, workers, repeats);
+        report("as loaded", loaded);
+        const std::pair<const char*, Graph::Placement> placements[] = {
+                {"first touch", Graph::FIRST_TOUCH},
+                {"interleaved", Graph::INTERLEAVED},
+                {"partitioned", Graph::PARTITIONED}};
+        for (const auto& [name, placement] : placements) {
+            Graph placed = graph;
+            auto start = std::chrono::steady_clock::now();
+            placed.place(placement, workers);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            Result result = run(placed, workers, repeats);
+            result.place_ms = elapsed.count();
+            if (result.checksum != loaded.checksum) {
+                throw std::runtime_error("Placed rows differ");
+            }
+            report(name, result);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
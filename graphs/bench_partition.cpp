@@ -0,0 +1,78 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Graph.h"
+#include "Partitioner.h"
+
+// Usage: bench_partition [edges_file [parts [shard_prefix]]]
+// Partitions the graph with both methods and reports time, edge cut, balance and
+// the size of the shards. With a prefix, the multilevel shards are written as
+// BINARY snapshots <prefix><part>.bin, one per worker process.
+
+template <typename Run>
+double measure_ms(Run run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void report(const std::string& name, const Graph& graph, const Partition& partition, double partition_ms,
+            const std::vector<Shard<int>>& shards, double shard_ms) {
+    size_t boundary = 0;
+    for (const auto& part : partition.boundary) {
+        boundary += part.size();
+    }
+    size_t ghosts = 0;
+    size_t max_arcs = 0;
+    for (const auto& shard : shards) {
+        ghosts += shard.graph.size() - shard.owned;
+        max_arcs = std::max(max_arcs, shard.graph.arc_count());
+    }
+    double cut_share = graph.edge_count() ? 100.0 * partition.edge_cut / graph.edge_count() : 0;
+    std::cout << std::left << std::setw(20) << name << std::right
+              << std::setw(12) << partition_ms << std::setw(12) << partition.edge_cut
+              << std::setw(9) << cut_share << "%" << std::setw(11) << partition.imbalance()
+              << std::setw(11) << boundary << std::setw(10) << ghosts << std::setw(12) << max_arcs
+              << std::setw(12) << shard_ms << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string path = argc > 1 ? argv[1] : "list_of_edges_t14_010.txt";
+        int parts = argc > 2 ? std::stoi(argv[2]) : 8;
+        std::string prefix = argc > 3 ? argv[3] : "";
+
+        Graph graph(path, Graph::EDGES_LIST, Graph::CSR);
+        std::cout << "Vertices: " << graph.size() << ", edges: " << graph.edge_count() << ", parts: " << parts << "\n";
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::left << std::setw(20) << "Method" << std::right
+                  << std::setw(12) << "Time, ms" << std::setw(12) << "Edge cut" << std::setw(10) << "Cut"
+                  << std::setw(11) << "Imbalance" << std::setw(11) << "Boundary" << std::setw(10) << "Ghosts"
+                  << std::setw(12) << "Max arcs" << std::setw(12) << "Shards, ms" << "\n";
+
+        Partition partition;
+        std::vector<Shard<int>> shards;
+        double partition_ms = measure_ms([&] { partition = Partitioner::LabelPropagation(graph, parts); });
+        double shard_ms = measure_ms([&] { shards = Partitioner::Shards(graph, partition); });
+        report("label propagation", graph, partition, partition_ms, shards, shard_ms);
+
+        partition_ms = measure_ms([&] { partition = Partitioner::Multilevel(graph, parts); });
+        shard_ms = measure_ms([&] { shards = Partitioner::Shards(graph, partition); });
+        report("multilevel", graph, partition, partition_ms, shards, shard_ms);
+
+        if (!prefix.empty()) {
+            for (const auto& shard : shards) {
+                shard.graph.save_binary(prefix + std::to_string(shard.part) + ".bin");
+            }
+            std::cout << "Wrote " << shards.size() << " shards to " << prefix << "*.bin\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
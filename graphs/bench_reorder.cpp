@@ -0,0 +1,170 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Graph.h"
+
+// Usage: bench_reorder [edges_file [repeats]]
+// Times BFS, Tarjan SCC and Floyd–Warshall on the file order and after each reordering.
+// The checksums must agree: relabeling changes memory layout, not the answers.
+
+template <typename Run>
+double measure_ms(int repeats, Run run, long long& checksum) {
+    checksum = run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        if (run() != checksum) {
+            throw std::runtime_error("Inconsistent benchmark results");
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+}
+
+// BFS from every vertex, returns the total number of vertices reached
+long long bfs_all(const Graph& graph) {
+    int n = graph.size();
+    std::vector<int> seen(n + 1, 0);
+    std::vector<int> queue(n);
+    long long reached = 0;
+    for (int s = 1; s <= n; ++s) {
+        size_t head = 0, tail = 0;
+        queue[tail++] = s;
+        seen[s] = s;
+        while (head < tail) {
+            int u = queue[head++];
+            for (auto [v, weight] : graph.neighbors(u)) {
+                if (seen[v] != s) {
+                    seen[v] = s;
+                    queue[tail++] = v;
+                }
+            }
+        }
+        reached += tail;
+    }
+    return reached;
+}
+
+// Iterative Tarjan, returns the number of strongly connected components
+long long tarjan_scc(const Graph& graph) {
+    int n = graph.size();
+    std::vector<int> index(n + 1, 0), low(n + 1, 0);
+    std::vector<char> on_stack(n + 1, 0);
+    std::vector<int> stack;
+    std::vector<std::pair<int, Graph::NeighborRange::iterator>> calls;
+    int timer = 0;
+    long long components = 0;
+    for (int s = 1; s <= n; ++s) {
+        if (index[s] != 0) continue;
+        index[s] = low[s] = ++timer;
+        stack.push_back(s);
+        on_stack[s] = 1;
+        calls.emplace_back(s, graph.neighbors(s).begin());
+        while (!calls.empty()) {
+            int u = calls.back().first;
+            auto& it = calls.back().second;
+            if (it != graph.neighbors(u).end()) {
+                int v = (*it).vertex;
+                ++it;
+                if (index[v] == 0) {
+                    index[v] = low[v] = ++timer;
+                    stack.push_back(v);
+                    on_stack[v] = 1;
+                    calls.emplace_back(v, graph.neighbors(v).begin());
+                } else if (on_stack[v]) {
+                    low[u] = std::min(low[u], index[v]);
+                }
+                continue;
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                int parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[u]);
+            }
+            if (low[u] == index[u]) {
+                int v;
+                do {
+                    v = stack.back();
+                    stack.pop_back();
+                    on_stack[v] = 0;
+                } while (v != u);
+                ++components;
+            }
+        }
+    }
+    return components;
+}
+
+// Floyd–Warshall on a flat matrix, returns the sum of all finite distances
+long long floyd_warshall(const Graph& graph) {
+    using Distance = Graph::distance_type;
+    const Distance inf = Graph::Traits::infinity();
+    size_t n = graph.size();
+    std::vector<Distance> dist(n * n, inf);
+    for (size_t u = 0; u < n; ++u) {
+        dist[u * n + u] = 0;
+        for (auto [v, weight] : graph.neighbors(static_cast<int>(u) + 1)) {
+            dist[u * n + v - 1] = std::min<Distance>(dist[u * n + v - 1], weight);
+        }
+    }
+    for (size_t k = 0; k < n; ++k) {
+        const Distance* row_k = &dist[k * n];
+        for (size_t i = 0; i < n; ++i) {
+            Distance d_ik = dist[i * n + k];
+            if (d_ik == inf) continue;
+            Distance* row_i = &dist[i * n];
+            for (size_t j = 0; j < n; ++j) {
+                if (row_k[j] != inf && d_ik + row_k[j] < row_i[j]) {
+                    row_i[j] = d_ik + row_k[j];
+                }
+            }
+        }
+    }
+    long long sum = 0;
+    for (Distance d : dist) {
+        if (d != inf) sum += d;
+    }
+    return sum;
+}
+
+void report(const std::string& name, const Graph& graph, int repeats) {
+    long long bfs_check, scc_check, fw_check;
+    double bfs = measure_ms(repeats, [&] { return bfs_all(graph); }, bfs_check);
+    double scc = measure_ms(repeats, [&] { return tarjan_scc(graph); }, scc_check);
+    double fw = measure_ms(1, [&] { return floyd_warshall(graph); }, fw_check);
+    std::cout << std::left << std::setw(24) << name << std::right
+              << std::setw(12) << bfs << std::setw(12) << scc << std::setw(14) << fw
+              << "   [" << bfs_check << " " << scc_check << " " << fw_check << "]\n";
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string path = argc > 1 ? argv[1] : "list_of_edges_t14_010.txt";
+        int repeats = argc > 2 ? std::stoi(argv[2]) : 3;
+
+        Graph original(path, Graph::EDGES_LIST, Graph::CSR);
+        std::cout << "Vertices: " << original.size() << "\n";
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::left << std::setw(24) << "Ordering" << std::right
+                  << std::setw(12) << "BFS, ms" << std::setw(12) << "Tarjan, ms" << std::setw(14) << "Floyd, ms"
+                  << "   [checksums]\n";
+        report("file order", original, repeats);
+
+        const std::pair<const char*, Graph::Ordering> orderings[] = {
+                {"reverse Cuthill-McKee", Graph::REVERSE_CUTHILL_MCKEE},
+                {"degree", Graph::DEGREE_ORDER},
+                {"BFS", Graph::BFS_ORDER},
+        };
+        for (auto [name, ordering] : orderings) {
+            Graph graph = original;
+            graph.reorder(ordering);
+            report(name, graph, repeats);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
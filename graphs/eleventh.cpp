@@ -1,21 +1,25 @@
 #include <iostream>
 #include <vector>
 #include <queue>
-#include <climits>
 #include <algorithm>
 #include "Graph.h"
 
+template <typename G>
 class BellmanFordMoore {
 private:
-    const Graph& graph_;
+    using Traits = typename G::Traits;
+    using Distance = typename G::distance_type;
+    static constexpr Distance kInfinity = Traits::infinity();
+
+    const G& graph_;
     int start_;
-    std::vector<int> distance_;
+    std::vector<Distance> distance_;
     std::vector<int> predecessor_;
     bool has_negative_cycle_;
 
     void initialize() {
         int n = graph_.size();
-        distance_.assign(n + 1, INT_MAX);
+        distance_.assign(n + 1, kInfinity);
         predecessor_.assign(n + 1, -1);
         distance_[start_] = 0;
     }
@@ -37,10 +41,9 @@ private:
                 queue.pop();
                 in_queue[u] = false;
 
-                for (int v : graph_.adjacency_list(u)) {
-                    int weight = graph_.weight(u, v);
-                    if (distance_[u] != INT_MAX && distance_[v] > distance_[u] + weight) {
-                        distance_[v] = distance_[u] + weight;
+                for (auto [v, weight] : graph_.neighbors(u)) {
+                    if (distance_[u] != kInfinity && distance_[v] > Traits::add(distance_[u], weight)) {
+                        distance_[v] = Traits::add(distance_[u], weight);
                         predecessor_[v] = u;
                         if (!in_queue[v]) {
                             queue.push(v);
@@ -53,8 +56,8 @@ private:
 
         has_negative_cycle_ = false;
         for (int u = 1; u <= n; ++u) {
-            for (int v : graph_.adjacency_list(u)) {
-                if (distance_[u] != INT_MAX && distance_[v] > distance_[u] + graph_.weight(u, v)) {
+            for (auto [v, weight] : graph_.neighbors(u)) {
+                if (distance_[u] != kInfinity && distance_[v] > Traits::add(distance_[u], weight)) {
                     has_negative_cycle_ = true;
                     return;
                 }
@@ -63,7 +66,7 @@ private:
     }
 
 public:
-    BellmanFordMoore(const Graph& graph, int start)
+    BellmanFordMoore(const G& graph, int start)
             : graph_(graph), start_(start), has_negative_cycle_(false) {
         if (start < 1 || start > graph.size()) {
             throw std::invalid_argument("Invalid start vertex");
@@ -75,12 +78,12 @@ public:
     bool hasNegativeCycle() const { return has_negative_cycle_; }
 
     void printDistances() const {
-        std::cout << "Shotest paths lengths from " << start_ << ":\n{";
+        std::cout << "Shotest paths lengths from " << graph_.external_id(start_) << ":\n{";
         int n = graph_.size();
         for (int v = 1; v <= n; ++v) {
             if (v > 1) std::cout << ", ";
-            std::cout << v << ": ";
-            if (distance_[v] == INT_MAX) {
+            std::cout << graph_.external_id(v) << ": ";
+            if (distance_[v] == kInfinity) {
                 std::cout << "+Infinity";
             } else {
                 std::cout << distance_[v];
@@ -94,7 +97,7 @@ int main() {
     try {
 
         Graph graph("C:/Users/goddammit/Documents/GitHub/laba2/graphs/list_of_edges_t11_008.txt", Graph::EDGES_LIST);
-        int start_vertex = 13;
+        int start_vertex = graph.internal_id(13);
         BellmanFordMoore bfm(graph, start_vertex);
 
         if (bfm.hasNegativeCycle()) {
@@ -102,6 +105,9 @@ int main() {
         } else {
             bfm.printDistances();
         }
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
     }
@@ -3,14 +3,56 @@
 #include <queue>
 #include "Graph.h"
 
+template <typename G>
 class BipartiteChecker {
 private:
-    const Graph& graph_;
+    const G& graph_;
     std::vector<int> colors_; // -1: не посещена, 0/1: цвет
     std::vector<int> partA_, partB_;
     bool is_bipartite_;
+    // Bit sets of coloured vertices and of each colour, used with bit rows
+    std::vector<uint64_t> colored_;
+    std::vector<uint64_t> color_bits_[2];
+
+    void paint(int v, int color) {
+        colors_[v] = color;
+        (color == 0 ? partA_ : partB_).push_back(v);
+        if (!colored_.empty()) {
+            colored_[v / 64] |= uint64_t{1} << (v % 64);
+            color_bits_[color][v / 64] |= uint64_t{1} << (v % 64);
+        }
+    }
+
+    // Same traversal on bit rows: a conflict is an intersection of u's row with its
+    // own colour class, the new neighbours are the row minus the coloured set.
+    bool bfs_check_bits(int start, const BitMatrix& bits) {
+        size_t words = bits.words_per_row();
+        std::vector<uint64_t> fresh(words);
+        std::queue<int> q;
+        q.push(start);
+        paint(start, 0);
+
+        while (!q.empty()) {
+            int u = q.front();
+            q.pop();
+
+            const uint64_t* row = bits.row(u);
+            if (BitMatrix::Intersects(row, color_bits_[colors_[u]].data(), words)) {
+                return false;
+            }
+            BitMatrix::Subtract(fresh.data(), row, colored_.data(), words);
+            BitMatrix::ForEachBit(fresh.data(), words, [&](size_t v) {
+                paint(static_cast<int>(v), 1 - colors_[u]);
+                q.push(static_cast<int>(v));
+            });
+        }
+        return true;
+    }
 
     bool bfs_check(int start) {
+        if (const BitMatrix* bits = graph_.adjacency_bits()) {
+            return bfs_check_bits(start, *bits);
+        }
         std::queue<int> q;
         q.push(start);
         colors_[start] = 0;
@@ -20,7 +62,7 @@ private:
             int u = q.front();
             q.pop();
 
-            for (int v : graph_.adjacency_list(u)) {
+            for (auto [v, weight] : graph_.neighbors(u)) {
                 if (colors_[v] == colors_[u]) {
                     return false;
                 }
@@ -35,11 +77,16 @@ private:
     }
 
 public:
-    BipartiteChecker(const Graph& graph) : graph_(graph), is_bipartite_(true) {
+    BipartiteChecker(const G& graph) : graph_(graph), is_bipartite_(true) {
         if (graph.is_directed()) {
             throw std::invalid_argument("Graph must be undirected");
         }
         colors_.resize(graph.size() + 1, -1);
+        if (const BitMatrix* bits = graph.adjacency_bits()) {
+            colored_.assign(bits->words_per_row(), 0);
+            color_bits_[0].assign(bits->words_per_row(), 0);
+            color_bits_[1].assign(bits->words_per_row(), 0);
+        }
 
         for (int u = 1; u <= graph.size() && is_bipartite_; ++u) {
             if (colors_[u] == -1) {
@@ -59,17 +106,21 @@ public:
 
 int main() {
     try {
-        Graph graph("C:/Users/goddammit/Documents/GitHub/laba2/graphs/list_of_edges_t5_011.txt", Graph::EDGES_LIST);
+        Graph graph("C:/Users/goddammit/Documents/GitHub/laba2/graphs/list_of_edges_t5_011.txt", Graph::EDGES_LIST,
+                    Graph::BITSET);
         BipartiteChecker checker(graph);
 
         if (checker.is_bipartite()) {
             std::cout << "Graph is bipartite\nPart A: ";
-            for (int v : checker.partA()) std::cout << v << " ";
+            for (int v : checker.partA()) std::cout << graph.external_id(v) << " ";
             std::cout << "\nPart B: ";
-            for (int v : checker.partB()) std::cout << v << " ";
+            for (int v : checker.partB()) std::cout << graph.external_id(v) << " ";
         } else {
             std::cout << "Graph is NOT bipartite";
         }
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what();
     }
@@ -1,12 +1,15 @@
 #include <iostream>
 #include <vector>
+#include <iterator>
 #include <queue>
 #include <algorithm>
 #include "Graph.h"
+#include "IoStats.h"
 
+template <typename G>
 class ConnectivityFinder {
 private:
-    const Graph& graph_;
+    const G& graph_;
     std::vector<bool> visited_;
     std::vector<std::vector<int>> components_;
 
@@ -20,11 +23,12 @@ private:
             int u = q.front();
             q.pop();
 
-            for (int v : graph_.adjacency_list(u)) {
+            for (auto [v, weight] : graph_.neighbors(u)) {
                 if (!visited_[v]) {
                     visited_[v] = true;
                     component.push_back(v);
                     q.push(v);
+                    graph_.prefetch(v);
                 }
             }
         }
@@ -34,30 +38,21 @@ private:
         visited_[u] = true;
         component.push_back(u);
 
-        for (int v : graph_.adjacency_list(u)) {
+        auto row = graph_.neighbors(u);
+        for (auto it = row.begin(); it != row.end(); ++it) {
+            int v = (*it).vertex;
             if (!visited_[v]) {
-                dfs(v, component);
-            }
-        }
-    }
-
-    std::vector<std::vector<int>> get_undirected_adjacency() const {
-        std::vector<std::vector<int>> undir_adj(graph_.size() + 1);
-        auto matrix = graph_.adjacency_matrix();
-
-        for (int u = 1; u <= graph_.size(); ++u) {
-            for (int v = 1; v <= graph_.size(); ++v) {
-                if (matrix[u][v] != 0) {
-                    undir_adj[u].push_back(v);
-                    undir_adj[v].push_back(u);
+                // The next sibling is read once v's subtree is done
+                if (std::next(it) != row.end()) {
+                    graph_.prefetch((*std::next(it)).vertex);
                 }
+                dfs(v, component);
             }
         }
-        return undir_adj;
     }
 
 public:
-    ConnectivityFinder(const Graph& graph) : graph_(graph) {
+    ConnectivityFinder(const G& graph) : graph_(graph) {
         visited_.resize(graph_.size() + 1, false);
     }
 
@@ -94,7 +89,6 @@ public:
             return find_components_bfs();
         }
 
-        auto undir_adj = get_undirected_adjacency();
         visited_.assign(visited_.size(), false);
         components_.clear();
 
@@ -110,11 +104,12 @@ public:
                     int curr = q.front();
                     q.pop();
 
-                    for (int v : undir_adj[curr]) {
+                    for (auto [v, weight] : graph_.undirected_neighbors(curr)) {
                         if (!visited_[v]) {
                             visited_[v] = true;
                             component.push_back(v);
                             q.push(v);
+                            graph_.prefetch(v, G::UNDIRECTED_ROWS);
                         }
                     }
                 }
@@ -125,9 +120,13 @@ public:
     }
 };
 
-int main() {
+// With a BINARY snapshot as the argument the graph is traversed out of core and
+// the I/O it caused is reported on stderr
+int main(int argc, char* argv[]) {
     try {
-        Graph graph("list_of_edges_t1_023.txt", Graph::EDGES_LIST);
+        IoCounters before = IoCounters::Sample();
+        Graph graph = argc > 1 ? Graph(argv[1], Graph::BINARY, Graph::EXTERNAL)
+                               : Graph("list_of_edges_t1_023.txt", Graph::EDGES_LIST);
         ConnectivityFinder finder(graph);
 
         std::vector<std::vector<int>> components;
@@ -149,26 +148,36 @@ int main() {
             }
         }
 
-        // Sort each component and then sort components by their first element
+        // Sort each component and then sort components by their first element,
+        // comparing the ids from the input file
+        auto by_id = [&graph](int a, int b) {
+            return graph.external_id(a) < graph.external_id(b);
+        };
         for (auto& comp : components) {
-            std::sort(comp.begin(), comp.end());
+            std::sort(comp.begin(), comp.end(), by_id);
         }
         std::sort(components.begin(), components.end(),
-                  [](const std::vector<int>& a, const std::vector<int>& b) {
-                      return a[0] < b[0];
+                  [&by_id](const std::vector<int>& a, const std::vector<int>& b) {
+                      return by_id(a[0], b[0]);
                   });
 
         std::cout << "Connected components:\n";
         for (const auto& comp : components) {
             std::cout << "[";
             for (size_t i = 0; i < comp.size(); ++i) {
-                std::cout << comp[i];
+                std::cout << graph.external_id(comp[i]);
                 if (i < comp.size() - 1)
                     std::cout << ", ";
             }
             std::cout << "]\n";
         }
 
+        if (argc > 1) {
+            (IoCounters::Sample() - before).print(std::cerr);
+        }
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
     }
@@ -2,29 +2,42 @@
 // Created by goddammit on 25.05.2025.
 //
 #include "Graph.h"
+#include "EdgeMap.h"
 #include <vector>
 #include <random>
 #include <cmath>
 #include <limits>
 #include <iostream>
 
+template <typename G>
 class AntColony {
 private:
-    const Graph& graph_;                // Ссылка на граф
+    const G& graph_;                    // Ссылка на граф
     int num_ants_;                      // Количество муравьев
     double alpha_;                      // Влияние феромонов
     double beta_;                       // Влияние эвристики
     double rho_;                        // Коэффициент испарения феромонов
     double initial_pheromone_;          // Начальный уровень феромонов
     int max_iterations_;                // Максимальное число итераций
-    std::vector<std::vector<double>> pheromones_; // Матрица феромонов
+    EdgeMap<double> pheromones_;        // Феромоны на каждой дуге
+    EdgeMap<double> heuristic_;         // (1 / вес)^beta, считается один раз
     std::vector<int> best_path_;        // Лучший найденный маршрут
     double best_path_length_;           // Длина лучшего маршрута
     std::mt19937 rng_;                  // Генератор случайных чисел
 
-    // Инициализация матрицы феромонов
+    // Инициализация феромонов
     void InitializePheromones() {
-        pheromones_.resize(graph_.size() + 1, std::vector<double>(graph_.size() + 1, initial_pheromone_));
+        pheromones_ = EdgeMap<double>(graph_, initial_pheromone_);
+    }
+
+    // Эвристика зависит только от весов рёбер, поэтому не пересчитывается на каждом шаге
+    void InitializeHeuristic() {
+        heuristic_ = EdgeMap<double>(graph_, 0.0);
+        for (int u = 1; u <= graph_.size(); ++u) {
+            for (size_t id : graph_.out_edges(u)) {
+                heuristic_[id] = std::pow(1.0 / static_cast<double>(graph_.edge_weight(id)), beta_);
+            }
+        }
     }
 
     // Построение маршрута одним муравьем
@@ -37,9 +50,12 @@ private:
 
         while (path.size() < graph_.size()) {
             std::vector<int> candidates;
-            for (int v = 1; v <= graph_.size(); ++v) {
-                if (!visited[v] && graph_.is_edge(current, v)) {
+            std::vector<size_t> arcs;
+            for (size_t id : graph_.out_edges(current)) {
+                int v = graph_.edge_target(id);
+                if (!visited[v]) {
                     candidates.push_back(v);
+                    arcs.push_back(id);
                 }
             }
             if (candidates.empty()) {
@@ -48,10 +64,9 @@ private:
 
             std::vector<double> probabilities;
             double total = 0.0;
-            for (int v : candidates) {
-                double tau = pheromones_[current][v];
-                double eta = 1.0 / graph_.weight(current, v);
-                double p = std::pow(tau, alpha_) * std::pow(eta, beta_);
+            for (size_t id : arcs) {
+                double tau = pheromones_[id];
+                double p = std::pow(tau, alpha_) * heuristic_[id];
                 probabilities.push_back(p);
                 total += p;
             }
@@ -70,25 +85,19 @@ private:
 
     // Обновление феромонов
     void UpdatePheromones(const std::vector<std::vector<int>>& paths, const std::vector<double>& path_lengths) {
-        // Испарение феромонов
-        for (int u = 1; u <= graph_.size(); ++u) {
-            for (int v = 1; v <= graph_.size(); ++v) {
-                if (graph_.is_edge(u, v)) {
-                    pheromones_[u][v] *= (1 - rho_);
-                }
-            }
+        // Испарение феромонов: один проход по массиву дуг
+        for (double& tau : pheromones_) {
+            tau *= (1 - rho_);
         }
-        // Отложение феромонов
-        for (int k = 0; k < num_ants_; ++k) {
-            if (paths[k].size() == graph_.size()) {
-                double delta = 1.0 / path_lengths[k];
-                for (size_t i = 0; i < paths[k].size() - 1; ++i) {
-                    int u = paths[k][i];
-                    int v = paths[k][i + 1];
-                    pheromones_[u][v] += delta;
-                    if (!graph_.is_directed()) {
-                        pheromones_[v][u] += delta;
-                    }
+        // Отложение феромонов; paths содержит только полные маршруты
+        for (size_t k = 0; k < paths.size(); ++k) {
+            double delta = 1.0 / path_lengths[k];
+            for (size_t i = 0; i < paths[k].size() - 1; ++i) {
+                size_t id = graph_.edge_id(paths[k][i], paths[k][i + 1]);
+                pheromones_[id] += delta;
+                size_t back = graph_.is_directed() ? G::kNoEdge : graph_.reverse_edge(id);
+                if (back != G::kNoEdge) {
+                    pheromones_[back] += delta;
                 }
             }
         }
@@ -105,13 +114,14 @@ private:
 
 public:
     // Конструктор
-    AntColony(const Graph& graph, int num_ants, double alpha, double beta, double rho,
+    AntColony(const G& graph, int num_ants, double alpha, double beta, double rho,
               double initial_pheromone, int max_iterations)
             : graph_(graph), num_ants_(num_ants), alpha_(alpha), beta_(beta), rho_(rho),
               initial_pheromone_(initial_pheromone), max_iterations_(max_iterations),
               best_path_length_(std::numeric_limits<double>::max()),
               rng_(std::random_device{}()) {
         InitializePheromones();
+        InitializeHeuristic();
     }
 
     // Запуск алгоритма
@@ -165,12 +175,16 @@ int main() {
     if (!best_path.empty()) {
         std::cout << "Лучший маршрут: ";
         for (int v : best_path) {
-            std::cout << v << " ";
+            std::cout << graph.external_id(v) << " ";
         }
         std::cout << "\nДлина маршрута: " << best_length << std::endl;
     } else {
         std::cout << "Маршрут, проходящий через все вершины, не найден." << std::endl;
     }
 
+    if (GraphStats::Requested()) {
+        graph.stats().print_json(std::cerr);
+    }
+
     return 0;
 }
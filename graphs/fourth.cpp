@@ -4,26 +4,48 @@
 #include <algorithm>
 #include "Graph.h"
 
+// Infinity sentinel for both integer (max) and floating point (inf) distances
+template <typename T>
+bool is_infinite(T value) {
+    if constexpr (std::numeric_limits<T>::has_infinity) {
+        return value == std::numeric_limits<T>::infinity();
+    } else {
+        return value == std::numeric_limits<T>::max();
+    }
+}
+
+template <typename G>
 class GraphAnalyzer {
 private:
-    const Graph& graph_;
-    std::vector<std::vector<int>> dist_matrix_;
+    using Traits = typename G::Traits;
+    using Distance = typename G::distance_type;
+    static constexpr Distance kInfinity = Traits::infinity();
+
+    const G& graph_;
+    // Row-major (n+1) x (n+1): distance from u to v at u * stride_ + v
+    std::vector<Distance> dist_matrix_;
+    size_t stride_ = 0;
     std::vector<int> degrees_;
-    std::vector<int> eccentricities_;
-    int diameter_;
+    std::vector<Distance> eccentricities_;
+    Distance diameter_;
     std::vector<int> peripheral_;
-    int radius_;
+    Distance radius_;
     std::vector<int> central_;
 
+    Distance* dist_row(int u) {
+        return dist_matrix_.data() + u * stride_;
+    }
+
     void init_distance_matrix() {
         int n = graph_.size();
-        dist_matrix_.resize(n + 1, std::vector<int>(n + 1, std::numeric_limits<int>::max()));
+        stride_ = n + 1;
+        dist_matrix_.assign(stride_ * stride_, kInfinity);
 
-        auto adj_matrix = graph_.adjacency_matrix();
         for (int u = 1; u <= n; ++u) {
-            dist_matrix_[u][u] = 0;
-            for (int v : graph_.adjacency_list(u)) {
-                dist_matrix_[u][v] = adj_matrix[u][v];
+            Distance* row = dist_row(u);
+            row[u] = 0;
+            for (auto [v, weight] : graph_.neighbors(u)) {
+                row[v] = weight;
             }
         }
     }
@@ -31,13 +53,15 @@ private:
     void floyd_warshall() {
         int n = graph_.size();
         for (int k = 1; k <= n; ++k) {
+            const Distance* row_k = dist_row(k);
             for (int i = 1; i <= n; ++i) {
-                if (dist_matrix_[i][k] == std::numeric_limits<int>::max()) continue;
+                Distance* row_i = dist_row(i);
+                if (row_i[k] == kInfinity) continue;
                 for (int j = 1; j <= n; ++j) {
-                    if (dist_matrix_[k][j] != std::numeric_limits<int>::max()) {
-                        int new_dist = dist_matrix_[i][k] + dist_matrix_[k][j];
-                        if (new_dist < dist_matrix_[i][j]) {
-                            dist_matrix_[i][j] = new_dist;
+                    if (row_k[j] != kInfinity) {
+                        Distance new_dist = Traits::add(row_i[k], row_k[j]);
+                        if (new_dist < row_i[j]) {
+                            row_i[j] = new_dist;
                         }
                     }
                 }
@@ -48,7 +72,7 @@ private:
     void compute_degrees() {
         degrees_.resize(graph_.size() + 1, 0);
         for (int u = 1; u <= graph_.size(); ++u) {
-            degrees_[u] = graph_.adjacency_list(u).size();
+            degrees_[u] = graph_.degree(u);
         }
     }
 
@@ -56,17 +80,18 @@ private:
         eccentricities_.resize(graph_.size() + 1, 0);
         int n = graph_.size();
         for (int u = 1; u <= n; ++u) {
-            int max_dist = 0;
+            Distance max_dist = 0;
             bool is_connected = true;
             for (int v = 1; v <= n; ++v) {
                 if (u == v) continue;
-                if (dist_matrix_[u][v] == std::numeric_limits<int>::max()) {
-                    eccentricities_[u] = std::numeric_limits<int>::max();
+                Distance dist = dist_matrix_[u * stride_ + v];
+                if (dist == kInfinity) {
+                    eccentricities_[u] = kInfinity;
                     is_connected = false;
                     break;
                 } else {
-                    if (dist_matrix_[u][v] > max_dist) {
-                        max_dist = dist_matrix_[u][v];
+                    if (dist > max_dist) {
+                        max_dist = dist;
                     }
                 }
             }
@@ -93,7 +118,7 @@ private:
     }
 
 public:
-    GraphAnalyzer(const Graph& graph) : graph_(graph) {
+    GraphAnalyzer(const G& graph) : graph_(graph) {
         if (graph.is_directed()) {
             throw std::invalid_argument("Graph must be undirected");
         }
@@ -106,18 +131,19 @@ public:
     }
 
     const std::vector<int>& degrees() const { return degrees_; }
-    const std::vector<int>& eccentricities() const { return eccentricities_; }
-    int diameter() const { return diameter_; }
+    const std::vector<Distance>& eccentricities() const { return eccentricities_; }
+    Distance diameter() const { return diameter_; }
     const std::vector<int>& peripheral() const { return peripheral_; }
-    int radius() const { return radius_; }
+    Distance radius() const { return radius_; }
     const std::vector<int>& central() const { return central_; }
 };
 
-void print_vector(const std::vector<int>& vec, const std::string& title) {
+template <typename G, typename T>
+void print_vector(const G& graph, const std::vector<T>& vec, const std::string& title) {
     std::cout << title << ":\n";
     for (size_t i = 1; i < vec.size(); ++i) {
-        std::cout << i << ": ";
-        if (vec[i] == std::numeric_limits<int>::max()) {
+        std::cout << graph.external_id(static_cast<int>(i)) << ": ";
+        if (is_infinite(vec[i])) {
             std::cout << "+Infinity";
         } else {
             std::cout << vec[i];
@@ -132,32 +158,35 @@ int main() {
         GraphAnalyzer analyzer(graph);
 
         // a) Степени вершин
-        print_vector(analyzer.degrees(), "Vertex degrees");
+        print_vector(graph, analyzer.degrees(), "Vertex degrees");
 
         // b) Эксцентриситеты
-        print_vector(analyzer.eccentricities(), "Eccentricities");
+        print_vector(graph, analyzer.eccentricities(), "Eccentricities");
 
         // c) Диаметр и периферийные вершины
         std::cout << "\nDiameter: ";
-        if (analyzer.diameter() == std::numeric_limits<int>::max()) {
+        if (is_infinite(analyzer.diameter())) {
             std::cout << "+Infinity";
         } else {
             std::cout << analyzer.diameter();
         }
         std::cout << "\nPeripheral vertices: ";
-        for (int v : analyzer.peripheral()) std::cout << v << " ";
+        for (int v : analyzer.peripheral()) std::cout << graph.external_id(v) << " ";
 
         // d) Радиус и центральные вершины
         std::cout << "\nRadius: ";
-        if (analyzer.radius() == std::numeric_limits<int>::max()) {
+        if (is_infinite(analyzer.radius())) {
             std::cout << "+Infinity";
         } else {
             std::cout << analyzer.radius();
         }
         std::cout << "\nCentral vertices: ";
-        for (int v : analyzer.central()) std::cout << v << " ";
+        for (int v : analyzer.central()) std::cout << graph.external_id(v) << " ";
         std::cout << std::endl;
 
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "\nError: " << e.what() << std::endl;
     }
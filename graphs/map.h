@@ -6,83 +6,251 @@
 #define UNTITLED2_LABIRINT_H
 
 #include <vector>
-#include <fstream>
-#include <sstream>
+#include <array>
+#include <string>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <utility>
-#include <iostream>
+#include "MappedFile.h"
+#include "ChunkedParser.h"
 
+// Лабиринт: rows x cols клеток, 1 — проход, 0 — стена. Каждая строка хранится
+// как words_per_row() 64-битных слов, клетка j — бит j % 64 слова j / 64;
+// биты за последним столбцом всегда нулевые, так что их можно читать как стены.
+// Клетка (i, j) имеет плоский номер cell(i, j) = i * cols + j.
 class Map {
+public:
+    // Соседи по сторонам, или по сторонам и диагоналям
+    enum Connectivity {
+        FOUR = 4,
+        EIGHT = 8
+    };
+
+    // До C соседей в массиве фиксированного размера, без выделения памяти
+    template <Connectivity C>
+    struct NeighborCells {
+        std::array<size_t, C> cells;
+        int count = 0;
+
+        [[nodiscard]] const size_t* begin() const { return cells.data(); }
+        [[nodiscard]] const size_t* end() const { return cells.data() + count; }
+        [[nodiscard]] int size() const { return count; }
+        [[nodiscard]] bool empty() const { return count == 0; }
+    };
+
 private:
-    std::vector<std::vector<int>> data;
-    int rows;
-    int cols;
+    int rows_ = 0;
+    int cols_ = 0;
+    size_t words_per_row_ = 0;
+    std::vector<uint64_t> bits_;
+
+    // Разбирает строку клеток в row; возвращает число прочитанных клеток
+    size_t ParseRow(const char* q, const char* end, uint64_t* row) const {
+        size_t j = 0;
+        uint64_t word = 0;
+        q = ChunkedParser::SkipBlanks(q, end);
+        while (q < end && *q != '\n') {
+            int value;
+            // Клетки почти всегда "0" или "1"; всё прочее разбирается как число
+            if ((*q == '0' || *q == '1') && (q + 1 == end || q[1] < '0' || q[1] > '9')) {
+                value = *q++ - '0';
+            } else {
+                q = ChunkedParser::ParseNumber(q, end, value);
+                if (q == nullptr) {
+                    throw std::runtime_error("Invalid map cell");
+                }
+            }
+            if (j == static_cast<size_t>(cols_)) {
+                throw std::runtime_error("Inconsistent row length");
+            }
+            word |= uint64_t{value != 0} << (j % 64);
+            if (++j % 64 == 0) {
+                row[j / 64 - 1] = word;
+                word = 0;
+            }
+            q = ChunkedParser::SkipBlanks(q, end);
+        }
+        if (j % 64 != 0) {
+            row[j / 64] = word;
+        }
+        return j;
+    }
+
+    static bool IsBlank(const char* line, const char* end) {
+        const char* q = ChunkedParser::SkipBlanks(line, end);
+        return q == end || *q == '\n';
+    }
 
 public:
-    Map(const std::string& filepath) {
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
-            throw std::runtime_error("Cannot open file");
+    // rows x cols стен; проходы расставляет set()
+    Map(int rows, int cols) : rows_(rows), cols_(cols) {
+        if (rows <= 0 || cols <= 0) {
+            throw std::runtime_error("Invalid map dimensions");
         }
+        words_per_row_ = (static_cast<size_t>(cols_) + 63) / 64;
+        bits_.assign(static_cast<size_t>(rows_) * words_per_row_, 0);
+    }
 
-        // Чтение первой строки для получения размеров
-        std::string line;
-        if (!std::getline(file, line)) {
+    Map(const std::string& filepath) {
+        MappedFile file(filepath);
+        const char* p = file.data();
+        const char* end = p + file.size();
+        if (file.size() == 0) {
             throw std::runtime_error("Empty file");
         }
-        std::istringstream sizeStream(line);
-        sizeStream >> rows >> cols;
-        if (rows <= 0 || cols <= 0) {
+
+        // Первая строка — размеры
+        p = ChunkedParser::SkipBlanks(p, end);
+        p = ChunkedParser::ParseNumber(p, end, rows_);
+        if (p != nullptr) {
+            p = ChunkedParser::ParseNumber(ChunkedParser::SkipBlanks(p, end), end, cols_);
+        }
+        if (p == nullptr || rows_ <= 0 || cols_ <= 0) {
             throw std::runtime_error("Invalid map dimensions");
         }
+        p = ChunkedParser::NextLine(p, end);
+        words_per_row_ = (static_cast<size_t>(cols_) + 63) / 64;
+        bits_.assign(static_cast<size_t>(rows_) * words_per_row_, 0);
 
-        // Чтение остальных строк как данных матрицы
-        while (std::getline(file, line)) {
-            std::vector<int> row;
-            std::istringstream iss(line);
-            int value;
-            while (iss >> value) {
-                row.push_back(value);
+        // Каждая непустая строка — строка лабиринта. Сначала куски считают свои
+        // строки, затем разбирают их сразу на место в bits_.
+        auto chunks = ChunkedParser::Split(p, end);
+        std::vector<size_t> first_row(chunks.size() + 1, 0);
+        ChunkedParser::Run(chunks, [&](size_t i, ChunkedParser::Chunk chunk) {
+            size_t count = 0;
+            for (const char* line = chunk.begin; line < chunk.end; line = ChunkedParser::NextLine(line, chunk.end)) {
+                count += !IsBlank(line, chunk.end);
             }
-            if (row.size() != static_cast<size_t>(cols)) {
-                throw std::runtime_error("Inconsistent row length");
-            }
-            data.push_back(row);
+            first_row[i + 1] = count;
+        });
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            first_row[i + 1] += first_row[i];
         }
-
-        if (data.size() != static_cast<size_t>(rows)) {
+        if (first_row.back() != static_cast<size_t>(rows_)) {
             throw std::runtime_error("Row count mismatch");
         }
+        ChunkedParser::Run(chunks, [&](size_t i, ChunkedParser::Chunk chunk) {
+            size_t row = first_row[i];
+            for (const char* line = chunk.begin; line < chunk.end; line = ChunkedParser::NextLine(line, chunk.end)) {
+                if (IsBlank(line, chunk.end)) {
+                    continue;
+                }
+                if (ParseRow(line, chunk.end, bits_.data() + row * words_per_row_) != static_cast<size_t>(cols_)) {
+                    throw std::runtime_error("Inconsistent row length");
+                }
+                ++row;
+            }
+        });
     }
 
+    // 1 для прохода, 0 для стены; без проверки границ
     int operator()(int i, int j) const {
-        if (i < 0 || i >= rows || j < 0 || j >= cols) {
+        return static_cast<int>((row(i)[j / 64] >> (j % 64)) & 1);
+    }
+
+    // То же с проверкой границ
+    int at(int i, int j) const {
+        if (i < 0 || i >= rows_ || j < 0 || j >= cols_) {
             throw std::out_of_range("Index out of bounds");
         }
-        return data[i][j];
+        return (*this)(i, j);
+    }
+
+    // Без проверки границ. Строки не делят слов, поэтому разные строки можно
+    // заполнять из разных потоков.
+    void set(int i, int j, bool passable) {
+        uint64_t& word = bits_[static_cast<size_t>(i) * words_per_row_ + j / 64];
+        uint64_t bit = uint64_t{1} << (j % 64);
+        word = passable ? word | bit : word & ~bit;
+    }
+
+    // Слова строки i: words_per_row() штук
+    [[nodiscard]] const uint64_t* row(int i) const {
+        return bits_.data() + static_cast<size_t>(i) * words_per_row_;
+    }
+
+    [[nodiscard]] size_t words_per_row() const {
+        return words_per_row_;
     }
 
     std::pair<int, int> size() const {
-        return {rows, cols};
+        return {rows_, cols_};
     }
 
-    std::vector<std::pair<int, int>> neighbors(int i, int j) const {
-        std::vector<std::pair<int, int>> result;
-        if (i < 0 || i >= rows || j < 0 || j >= cols) {
-            return result;
-        }
+    [[nodiscard]] size_t cell_count() const {
+        return static_cast<size_t>(rows_) * cols_;
+    }
 
-        const int directions[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
-        for (const auto& dir : directions) {
-            int ni = i + dir[0];
-            int nj = j + dir[1];
-            if (ni >= 0 && ni < rows && nj >= 0 && nj < cols) {
-                if (data[ni][nj] != 0) {
-                    result.emplace_back(ni, nj);
-                }
+    [[nodiscard]] size_t cell(int i, int j) const {
+        return static_cast<size_t>(i) * cols_ + j;
+    }
+
+    [[nodiscard]] int cell_row(size_t cell) const {
+        return static_cast<int>(cell / cols_);
+    }
+
+    [[nodiscard]] int cell_col(size_t cell) const {
+        return static_cast<int>(cell % cols_);
+    }
+
+    // Вызывает visit(номер соседа) для каждого проходимого соседа клетки в порядке
+    // вверх, вниз, влево, вправо, затем для EIGHT: вверх-влево, вверх-вправо,
+    // вниз-влево, вниз-вправо. По диагонали можно пройти и между двумя стенами.
+    // Клетка должна лежать в лабиринте; проверки развёрнуты при компиляции.
+    template <Connectivity C = FOUR, typename Visit>
+    void for_each_neighbor(size_t cell, Visit visit) const {
+        static_assert(C == FOUR || C == EIGHT, "Connectivity must be FOUR or EIGHT");
+        int i = cell_row(cell);
+        int j = cell_col(cell);
+        size_t cols = cols_;
+        bool up = i > 0;
+        bool down = i + 1 < rows_;
+        bool left = j > 0;
+        bool right = j + 1 < cols_;
+        if (up && (*this)(i - 1, j)) {
+            visit(cell - cols);
+        }
+        if (down && (*this)(i + 1, j)) {
+            visit(cell + cols);
+        }
+        if (left && (*this)(i, j - 1)) {
+            visit(cell - 1);
+        }
+        if (right && (*this)(i, j + 1)) {
+            visit(cell + 1);
+        }
+        if constexpr (C == EIGHT) {
+            if (up && left && (*this)(i - 1, j - 1)) {
+                visit(cell - cols - 1);
+            }
+            if (up && right && (*this)(i - 1, j + 1)) {
+                visit(cell - cols + 1);
+            }
+            if (down && left && (*this)(i + 1, j - 1)) {
+                visit(cell + cols - 1);
+            }
+            if (down && right && (*this)(i + 1, j + 1)) {
+                visit(cell + cols + 1);
             }
         }
+    }
+
+    // Те же соседи, собранные в массив на стеке
+    template <Connectivity C = FOUR>
+    [[nodiscard]] NeighborCells<C> neighbor_cells(size_t cell) const {
+        NeighborCells<C> result;
+        for_each_neighbor<C>(cell, [&result](size_t next) { result.cells[result.count++] = next; });
+        return result;
+    }
 
+    // Копия соседей по сторонам в виде пар (строка, столбец); пустая вне лабиринта
+    std::vector<std::pair<int, int>> neighbors(int i, int j) const {
+        std::vector<std::pair<int, int>> result;
+        if (i < 0 || i >= rows_ || j < 0 || j >= cols_) {
+            return result;
+        }
+        for_each_neighbor(cell(i, j), [&](size_t next) { result.emplace_back(cell_row(next), cell_col(next)); });
         return result;
     }
 };
@@ -1,20 +1,25 @@
 #include <iostream>
 #include <vector>
-#include <climits>
+#include <limits>
 #include <algorithm>
 #include "Graph.h"
 
+template <typename G>
 class MSTFinder {
 private:
-    const Graph& graph_;
+    using Weight = typename G::weight_type;
+    using Distance = typename G::distance_type;
+    static constexpr Weight kNoWeight = std::numeric_limits<Weight>::max();
+
+    const G& graph_;
     std::vector<bool> included_;
     std::vector<int> parent_;
-    std::vector<int> min_weight_;
-    std::vector<std::tuple<int, int, int>> mst_edges_;
-    int total_weight_;
+    std::vector<Weight> min_weight_;
+    std::vector<std::tuple<int, int, Weight>> mst_edges_;
+    Distance total_weight_;
 
     int find_min_weight_vertex() {
-        int min_weight = INT_MAX;
+        Weight min_weight = kNoWeight;
         int min_vertex = -1;
 
         for (int v = 1; v <= graph_.size(); ++v) {
@@ -28,7 +33,7 @@ private:
 
     void prim() {
         int n = graph_.size();
-        min_weight_.assign(n + 1, INT_MAX);
+        min_weight_.assign(n + 1, kNoWeight);
         parent_.assign(n + 1, -1);
         included_.assign(n + 1, false);
 
@@ -43,10 +48,10 @@ private:
             included_[u] = true;
 
             // Обновляем веса для смежных вершин
-            for (int v = 1; v <= n; ++v) {
-                if (graph_.is_edge(u, v) && !included_[v] && graph_.weight(u, v) < min_weight_[v]) {
+            for (auto [v, weight] : graph_.neighbors(u)) {
+                if (!included_[v] && weight < min_weight_[v]) {
                     parent_[v] = u;
-                    min_weight_[v] = graph_.weight(u, v);
+                    min_weight_[v] = weight;
                 }
             }
         }
@@ -62,20 +67,20 @@ private:
     }
 
 public:
-    MSTFinder(const Graph& graph) : graph_(graph), total_weight_(0) {
+    MSTFinder(const G& graph) : graph_(graph), total_weight_(0) {
         if (graph.is_directed()) {
             throw std::invalid_argument("Graph must be undirected");
         }
         prim();
     }
 
-    const std::vector<std::tuple<int, int, int>>& edges() const { return mst_edges_; }
-    int total_weight() const { return total_weight_; }
+    const std::vector<std::tuple<int, int, Weight>>& edges() const { return mst_edges_; }
+    Distance total_weight() const { return total_weight_; }
 
     void print_mst() const {
         std::cout << "Minimum Spanning Tree Edges (Total Weight: " << total_weight_ << "):\n";
         for (const auto& edge : mst_edges_) {
-            std::cout << std::get<0>(edge) << " - " << std::get<1>(edge)
+            std::cout << graph_.external_id(std::get<0>(edge)) << " - " << graph_.external_id(std::get<1>(edge))
                       << " (w=" << std::get<2>(edge) << ")\n";
         }
     }
@@ -86,6 +91,9 @@ int main() {
         Graph graph("C:/Users/goddammit/Documents/GitHub/laba2/graphs/matrix_t9_004.txt", Graph::MATRIX);
         MSTFinder mst(graph);
         mst.print_mst();
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
     }
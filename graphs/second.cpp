@@ -1,35 +1,39 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
-#include <set>
 #include "Graph.h"
+#include "EdgeMap.h"
 
+template <typename G>
 class BridgeArticulationFinder {
 private:
-    const Graph& graph_;
+    const G& graph_;
     std::vector<int> entry_time_;
     std::vector<int> low_;
     std::vector<bool> visited_;
     int timer_;
-    std::set<std::pair<int, int>> bridges_;
+    EdgeMap<char> is_bridge_;               // Marks the tree arc of every bridge
+    std::vector<std::pair<int, int>> bridges_;
     std::vector<int> articulation_points_;  // Changed to vector
     std::vector<bool> is_ap_added_;         // Track added articulation points
 
-    void dfs(int u, int parent = -1) {
+    // parent_arc is the arc back to the DFS parent, which must not count as a back edge
+    void dfs(int u, int parent = -1, size_t parent_arc = G::kNoEdge) {
         visited_[u] = true;
         entry_time_[u] = low_[u] = timer_++;
         int children = 0;
         bool is_articulation = false;
 
-        for (int v : graph_.adjacency_list(u)) {
-            if (v == parent) continue;
+        for (size_t id : graph_.out_edges(u)) {
+            if (id == parent_arc) continue;
+            int v = graph_.edge_target(id);
 
             if (!visited_[v]) {
-                dfs(v, u);
+                dfs(v, u, graph_.reverse_edge(id));
                 low_[u] = std::min(low_[u], low_[v]);
 
                 if (low_[v] > entry_time_[u]) {
-                    bridges_.insert({std::min(u, v), std::max(u, v)});
+                    is_bridge_[id] = 1;
                 }
 
                 if (low_[v] >= entry_time_[u] && parent != -1) {
@@ -52,7 +56,7 @@ private:
     }
 
 public:
-    BridgeArticulationFinder(const Graph& graph) : graph_(graph) {
+    BridgeArticulationFinder(const G& graph) : graph_(graph) {
         if (graph.is_directed()) {
             throw std::invalid_argument("Graph must be undirected");
         }
@@ -61,6 +65,7 @@ public:
         low_.resize(n + 1);
         visited_.assign(n + 1, false);
         is_ap_added_.assign(n + 1, false);  // Initialize
+        is_bridge_ = EdgeMap<char>(graph, 0);
         timer_ = 0;
     }
 
@@ -70,9 +75,19 @@ public:
                 dfs(u);
             }
         }
+        for (int u = 1; u <= graph_.size(); ++u) {
+            for (size_t id : graph_.out_edges(u)) {
+                if (is_bridge_[id]) {
+                    int v = graph_.edge_target(id);
+                    bridges_.emplace_back(std::min(u, v), std::max(u, v));
+                }
+            }
+        }
+        std::sort(bridges_.begin(), bridges_.end());
     }
 
-    const std::set<std::pair<int, int>>& get_bridges() const {
+    // Sorted by (u, v) with u < v
+    const std::vector<std::pair<int, int>>& get_bridges() const {
         return bridges_;
     }
 
@@ -81,7 +96,8 @@ public:
     }
 };
 
-void print_results(const std::set<std::pair<int, int>>& bridges,
+template <typename G>
+void print_results(const G& graph, const std::vector<std::pair<int, int>>& bridges,
                    const std::vector<int>& articulation_points) {
     // Print bridges in sorted order
     std::cout << "Bridges:\n";
@@ -90,9 +106,9 @@ void print_results(const std::set<std::pair<int, int>>& bridges,
     } else {
         std::cout << "[";
         auto it = bridges.begin();
-        std::cout << it->first << "-" << it->second;
+        std::cout << graph.external_id(it->first) << "-" << graph.external_id(it->second);
         for (++it; it != bridges.end(); ++it) {
-            std::cout << ", " << it->first << "-" << it->second;
+            std::cout << ", " << graph.external_id(it->first) << "-" << graph.external_id(it->second);
         }
         std::cout << "]\n";
     }
@@ -103,9 +119,9 @@ void print_results(const std::set<std::pair<int, int>>& bridges,
         std::cout << "[]\n";
     } else {
         std::cout << "[";
-        std::cout << articulation_points[0];
+        std::cout << graph.external_id(articulation_points[0]);
         for (int i = 1; i < articulation_points.size(); ++i) {
-            std::cout << ", " << articulation_points[i];
+            std::cout << ", " << graph.external_id(articulation_points[i]);
         }
         std::cout << "]\n";
     }
@@ -120,8 +136,11 @@ int main() {
         auto bridges = finder.get_bridges();
         auto articulation_points = finder.get_articulation_points();
 
-        print_results(bridges, articulation_points);
+        print_results(graph, bridges, articulation_points);
 
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
     }
@@ -1,53 +1,54 @@
 #include <iostream>
 #include <vector>
+#include <iterator>
 #include <stack>
 #include <algorithm>
 #include "Graph.h"
+#include "IoStats.h"
 
+template <typename G>
 class StronglyConnectedComponents {
 private:
-    const Graph& graph_;
+    const G& graph_;
     std::vector<bool> visited_;
     std::vector<std::vector<int>> components_;
     std::stack<int> order_;
 
+    // Перед спуском в v просим подгрузить следующего соседа: его строку
+    // прочитаем, когда поддерево v будет пройдено
     void dfs_pass1(int u) {
         visited_[u] = true;
-        for (int v : graph_.adjacency_list(u)) {
+        auto row = graph_.neighbors(u);
+        for (auto it = row.begin(); it != row.end(); ++it) {
+            int v = (*it).vertex;
             if (!visited_[v]) {
+                if (std::next(it) != row.end()) {
+                    graph_.prefetch((*std::next(it)).vertex);
+                }
                 dfs_pass1(v);
             }
         }
         order_.push(u);
     }
 
-    void dfs_pass2(int u, std::vector<int>& component, const std::vector<std::vector<int>>& transpose) {
+    // Второй проход идёт по входящим дугам: транспонированный граф кэширует сам граф
+    void dfs_pass2(int u, std::vector<int>& component) {
         visited_[u] = true;
         component.push_back(u);
-        for (int v : transpose[u]) {
+        auto row = graph_.in_neighbors(u);
+        for (auto it = row.begin(); it != row.end(); ++it) {
+            int v = (*it).vertex;
             if (!visited_[v]) {
-                dfs_pass2(v, component, transpose);
-            }
-        }
-    }
-
-    std::vector<std::vector<int>> transpose_graph() const {
-        int n = graph_.size();
-        std::vector<std::vector<int>> transpose(n + 1);
-        auto matrix = graph_.adjacency_matrix();
-
-        for (int u = 1; u <= n; ++u) {
-            for (int v = 1; v <= n; ++v) {
-                if (matrix[u][v] != 0) {
-                    transpose[v].push_back(u);
+                if (std::next(it) != row.end()) {
+                    graph_.prefetch((*std::next(it)).vertex, G::IN_ROWS);
                 }
+                dfs_pass2(v, component);
             }
         }
-        return transpose;
     }
 
 public:
-    StronglyConnectedComponents(const Graph& graph) : graph_(graph) {
+    StronglyConnectedComponents(const G& graph) : graph_(graph) {
         if (!graph.is_directed()) {
             throw std::invalid_argument("Graph must be directed");
         }
@@ -61,9 +62,6 @@ public:
             }
         }
 
-        // Транспонирование графа
-        auto transpose = transpose_graph();
-
         // Второй проход DFS в обратном порядке
         visited_.assign(n + 1, false);
         while (!order_.empty()) {
@@ -71,7 +69,7 @@ public:
             order_.pop();
             if (!visited_[u]) {
                 std::vector<int> component;
-                dfs_pass2(u, component, transpose);
+                dfs_pass2(u, component);
                 components_.push_back(component);
             }
         }
@@ -86,18 +84,28 @@ public:
         for (size_t i = 0; i < components_.size(); ++i) {
             std::cout << "Component " << i + 1 << ": ";
             for (int v : components_[i]) {
-                std::cout << v << " ";
+                std::cout << graph_.external_id(v) << " ";
             }
             std::cout << "\n";
         }
     }
 };
 
-int main() {
+// With a BINARY snapshot as the argument the graph is traversed out of core and
+// the I/O it caused is reported on stderr
+int main(int argc, char* argv[]) {
     try {
-        Graph graph("C:/Users/goddammit/Documents/GitHub/laba2/graphs/list_of_edges_t7_017.txt", Graph::EDGES_LIST);
+        IoCounters before = IoCounters::Sample();
+        Graph graph = argc > 1 ? Graph(argv[1], Graph::BINARY, Graph::EXTERNAL)
+                               : Graph("C:/Users/goddammit/Documents/GitHub/laba2/graphs/list_of_edges_t7_017.txt", Graph::EDGES_LIST);
         StronglyConnectedComponents scc(graph);
         scc.print_components();
+        if (argc > 1) {
+            (IoCounters::Sample() - before).print(std::cerr);
+        }
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
     }
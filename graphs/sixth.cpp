@@ -1,39 +1,9 @@
 #include "map.h"
-#include <queue>
-#include <unordered_map>
+#include "GridBfs.h"
 #include <iostream>
-#include <algorithm>
 
 std::vector<std::pair<int, int>> find_path(const Map& map, std::pair<int, int> start, std::pair<int, int> end) {
-    std::queue<std::pair<int, int>> q;
-    std::unordered_map<int, std::unordered_map<int, std::pair<int, int>>> parent;
-
-    q.push(start);
-    parent[start.first][start.second] = {-1, -1};
-
-    while (!q.empty()) {
-        auto current = q.front();
-        q.pop();
-
-        if (current == end) {
-            std::vector<std::pair<int, int>> path;
-            while (current.first != -1) {
-                path.push_back(current);
-                current = parent[current.first][current.second];
-            }
-            std::reverse(path.begin(), path.end());
-            return path;
-        }
-
-        for (const auto& neighbor : map.neighbors(current.first, current.second)) {
-            if (!parent[neighbor.first].count(neighbor.second)) {
-                parent[neighbor.first][neighbor.second] = current;
-                q.push(neighbor);
-            }
-        }
-    }
-
-    return {};
+    return GridBfs(map).find_path(start, end);
 }
 
 int main() {
@@ -0,0 +1,33 @@
+#include <iostream>
+#include <string>
+#include "Graph.h"
+
+// Converts a text graph into a BINARY snapshot once, so that later runs can
+// open it with Graph(path, Graph::BINARY) instead of parsing the text again.
+// Usage: snapshot <matrix|edges|adjacency> <input.txt> <output.bin>
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <matrix|edges|adjacency> <input.txt> <output.bin>\n";
+        return 1;
+    }
+    try {
+        std::string format = argv[1];
+        Graph::FileType type;
+        if (format == "matrix") {
+            type = Graph::MATRIX;
+        } else if (format == "edges") {
+            type = Graph::EDGES_LIST;
+        } else if (format == "adjacency") {
+            type = Graph::ADJACENCY_LIST;
+        } else {
+            throw std::invalid_argument("Unknown format: " + format);
+        }
+        Graph graph(argv[2], type, Graph::CSR);
+        graph.save_binary(argv[3]);
+        std::cout << "Saved " << graph.size() << " vertices to " << argv[3] << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,26 +1,32 @@
 #include <iostream>
 #include <vector>
-#include <climits>
+#include <memory>
 #include <algorithm>
-#include <unordered_set>
 #include "Graph.h"
+#include "SubgraphView.h"
 
-class FloydWarshallAnalyzer {
+// Кратчайшие пути между всеми парами вершин графа (Флойд — Уоршелл)
+template <typename G>
+class ShortestPaths {
 private:
-    const Graph& graph_;
-    std::vector<std::vector<int>> dist_;
+    using Traits = typename G::Traits;
+    using Distance = typename G::distance_type;
+    static constexpr Distance kInfinity = Traits::infinity();
+
+    const G& graph_;
+    std::vector<std::vector<Distance>> dist_;
     std::vector<std::vector<int>> next_;
 
     void initialize() {
         int n = graph_.size();
-        dist_.resize(n + 1, std::vector<int>(n + 1, INT_MAX));
+        dist_.resize(n + 1, std::vector<Distance>(n + 1, kInfinity));
         next_.resize(n + 1, std::vector<int>(n + 1, -1));
 
         // Инициализация матриц
         for (int u = 1; u <= n; ++u) {
             dist_[u][u] = 0;
-            for (int v : graph_.adjacency_list(u)) {
-                dist_[u][v] = graph_.weight(u, v);
+            for (auto [v, weight] : graph_.neighbors(u)) {
+                dist_[u][v] = weight;
                 next_[u][v] = v;
             }
         }
@@ -30,10 +36,12 @@ private:
         int n = graph_.size();
         for (int k = 1; k <= n; ++k) {
             for (int i = 1; i <= n; ++i) {
-                if (dist_[i][k] == INT_MAX) continue;
+                if (dist_[i][k] == kInfinity) continue;
                 for (int j = 1; j <= n; ++j) {
-                    if (dist_[k][j] != INT_MAX && dist_[i][j] > dist_[i][k] + dist_[k][j]) {
-                        dist_[i][j] = dist_[i][k] + dist_[k][j];
+                    if (dist_[k][j] == kInfinity) continue;
+                    Distance through_k = Traits::add(dist_[i][k], dist_[k][j]);
+                    if (dist_[i][j] > through_k) {
+                        dist_[i][j] = through_k;
                         next_[i][j] = next_[i][k];
                     }
                 }
@@ -42,13 +50,13 @@ private:
     }
 
 public:
-    FloydWarshallAnalyzer(const Graph& graph) : graph_(graph) {
+    ShortestPaths(const G& graph) : graph_(graph) {
         initialize();
         computeShortestPaths();
     }
 
     // Восстановление пути между u и v
-    std::vector<int> reconstructPath(int u, int v) {
+    std::vector<int> reconstructPath(int u, int v) const {
         if (next_[u][v] == -1) return {};
 
         std::vector<int> path;
@@ -60,91 +68,142 @@ public:
         return path;
     }
 
-    // Анализ компонент связности
-    void analyzeComponents() {
+    // Эксцентриситет каждой вершины 1..n; недостижимые вершины не учитываются
+    std::vector<Distance> eccentricities() const {
         int n = graph_.size();
-        std::vector<bool> visited(n + 1, false);
-        std::vector<std::vector<int>> components;
-
-        // Поиск компонент связности
+        std::vector<Distance> ecc(n + 1, 0);
         for (int u = 1; u <= n; ++u) {
-            if (!visited[u]) {
-                std::vector<int> component;
-                std::unordered_set<int> compSet;
-
-                // Собираем все вершины в компоненте
-                for (int v = 1; v <= n; ++v) {
-                    if (!visited[v] && (dist_[u][v] != INT_MAX || dist_[v][u] != INT_MAX)) {
-                        visited[v] = true;
-                        component.push_back(v);
-                        compSet.insert(v);
-                    }
+            for (int v = 1; v <= n; ++v) {
+                if (dist_[u][v] != kInfinity) {
+                    ecc[u] = std::max(ecc[u], dist_[u][v]);
                 }
-                components.push_back(component);
             }
         }
+        return ecc;
+    }
 
-        // Вывод информации о связности
-        std::cout << "Graph is " << (components.size() == 1 ? "" : "NOT ")
-                  << "connected and contains " << components.size() << " connected components.\n\n";
-
-        // Анализ каждой компоненты
-        for (const auto& comp : components) {
-            // Вывод вершин
-            std::cout << "Vertices numbers:\n\t";
-            for (int v : comp) std::cout << v << "\t";
-            std::cout << "\n";
-
-            // Вывод степеней вершин
-            std::cout << "Vertices degrees:\n\t";
-            for (int v : comp) std::cout << graph_.adjacency_list(v).size() << "\t";
-            std::cout << "\n";
-
-            // Вычисление эксцентриситетов
-            std::cout << "Eccentricity:\n\t";
-            std::vector<int> ecc(comp.size());
-            for (int i = 0; i < comp.size(); ++i) {
-                int maxDist = 0;
-                for (int j = 0; j < comp.size(); ++j) {
-                    if (dist_[comp[i]][comp[j]] != INT_MAX) {
-                        maxDist = std::max(maxDist, dist_[comp[i]][comp[j]]);
+    // Вершины, степени, эксцентриситеты, радиус и диаметр графа
+    void report() const {
+        int n = graph_.size();
+        std::vector<Distance> ecc = eccentricities();
+
+        // Вывод вершин
+        std::cout << "Vertices numbers:\n\t";
+        for (int v = 1; v <= n; ++v) std::cout << graph_.external_id(v) << "\t";
+        std::cout << "\n";
+
+        // Вывод степеней вершин
+        std::cout << "Vertices degrees:\n\t";
+        for (int v = 1; v <= n; ++v) std::cout << graph_.degree(v) << "\t";
+        std::cout << "\n";
+
+        std::cout << "Eccentricity:\n\t";
+        for (int v = 1; v <= n; ++v) std::cout << ecc[v] << "\t";
+        std::cout << "\n";
+
+        // Вычисление радиуса и центра
+        Distance radius = *std::min_element(ecc.begin() + 1, ecc.end());
+        Distance diameter = *std::max_element(ecc.begin() + 1, ecc.end());
+
+        std::vector<int> central;
+        std::vector<int> peripherial;
+        for (int v = 1; v <= n; ++v) {
+            if (ecc[v] == radius) central.push_back(v);
+            if (ecc[v] == diameter) peripherial.push_back(v);
+        }
+
+        // Вывод характеристик
+        std::cout << "R = " << radius << ".0\n";
+        std::cout << "Central vertices:\n[";
+        for (int i = 0; i < central.size(); ++i) {
+            std::cout << graph_.external_id(central[i]);
+            if (i < central.size() - 1) std::cout << ", ";
+        }
+        std::cout << "]\n";
+
+        std::cout << "D = " << diameter << ".0\n";
+        std::cout << "Peripherial vertices:\n[";
+        for (int i = 0; i < peripherial.size(); ++i) {
+            std::cout << graph_.external_id(peripherial[i]);
+            if (i < peripherial.size() - 1) std::cout << ", ";
+        }
+        std::cout << "]\n\n";
+    }
+};
+
+// Пути и характеристики по компонентам связности. Каждая компонента — это
+// SubgraphView поверх исходного графа, и ShortestPaths строит матрицы только
+// её размера; ни матрицы n x n, ни копии графа не нужно. Матрицы компоненты
+// считаются при первом обращении и служат и путям, и анализу.
+template <typename G>
+class FloydWarshallAnalyzer {
+private:
+    using View = SubgraphView<G>;
+
+    const G& graph_;
+    std::vector<std::vector<int>> components_;  // вершины по возрастанию номеров
+    std::vector<int> component_of_;
+    std::vector<std::unique_ptr<View>> views_;
+    std::vector<std::unique_ptr<ShortestPaths<View>>> paths_;
+
+    // Компоненты ищутся обходом в ширину, без матрицы достижимости
+    void findComponents() {
+        int n = graph_.size();
+        component_of_.assign(n + 1, -1);
+        for (int u = 1; u <= n; ++u) {
+            if (component_of_[u] != -1) continue;
+            int c = static_cast<int>(components_.size());
+            std::vector<int> component = {u};
+            component_of_[u] = c;
+            for (size_t head = 0; head < component.size(); ++head) {
+                for (auto [v, weight] : graph_.undirected_neighbors(component[head])) {
+                    if (component_of_[v] == -1) {
+                        component_of_[v] = c;
+                        component.push_back(v);
                     }
                 }
-                ecc[i] = maxDist;
-                std::cout << ecc[i] << "\t";
             }
-            std::cout << "\n";
+            std::sort(component.begin(), component.end());
+            components_.push_back(std::move(component));
+        }
+        views_.resize(components_.size());
+        paths_.resize(components_.size());
+    }
 
-            // Вычисление радиуса и центра
-            int radius = *std::min_element(ecc.begin(), ecc.end());
-            int diameter = *std::max_element(ecc.begin(), ecc.end());
+    const ShortestPaths<View>& pathsOf(int c) {
+        if (!paths_[c]) {
+            views_[c] = std::make_unique<View>(graph_, components_[c]);
+            paths_[c] = std::make_unique<ShortestPaths<View>>(*views_[c]);
+        }
+        return *paths_[c];
+    }
 
-            std::vector<int> central;
-            for (int i = 0; i < comp.size(); ++i) {
-                if (ecc[i] == radius) central.push_back(comp[i]);
-            }
+public:
+    FloydWarshallAnalyzer(const G& graph) : graph_(graph) {
+        findComponents();
+    }
 
-            std::vector<int> peripherial;
-            for (int i = 0; i < comp.size(); ++i) {
-                if (ecc[i] == diameter) peripherial.push_back(comp[i]);
-            }
+    // Восстановление пути между u и v; из разных компонент пути нет
+    std::vector<int> reconstructPath(int u, int v) {
+        int c = component_of_[u];
+        if (c != component_of_[v]) return {};
 
-            // Вывод характеристик
-            std::cout << "R = " << radius << ".0\n";
-            std::cout << "Central vertices:\n[";
-            for (int i = 0; i < central.size(); ++i) {
-                std::cout << central[i];
-                if (i < central.size() - 1) std::cout << ", ";
-            }
-            std::cout << "]\n";
+        const ShortestPaths<View>& paths = pathsOf(c);
+        const View& view = *views_[c];
+        std::vector<int> path = paths.reconstructPath(view.local_vertex(u), view.local_vertex(v));
+        for (int& w : path) w = view.parent_vertex(w);
+        return path;
+    }
 
-            std::cout << "D = " << diameter << ".0\n";
-            std::cout << "Peripherial vertices:\n[";
-            for (int i = 0; i < peripherial.size(); ++i) {
-                std::cout << peripherial[i];
-                if (i < peripherial.size() - 1) std::cout << ", ";
-            }
-            std::cout << "]\n\n";
+    // Анализ компонент связности
+    void analyzeComponents() {
+        // Вывод информации о связности
+        std::cout << "Graph is " << (components_.size() == 1 ? "" : "NOT ")
+                  << "connected and contains " << components_.size() << " connected components.\n\n";
+
+        // Анализ каждой компоненты на её виде
+        for (int c = 0; c < static_cast<int>(components_.size()); ++c) {
+            pathsOf(c).report();
         }
     }
 };
@@ -156,11 +215,11 @@ int main() {
         FloydWarshallAnalyzer analyzer(graph);
 
         // Пример вывода пути
-        int u = 2, v = 50;
-        auto path = analyzer.reconstructPath(u, v);
+        int64_t u = 2, v = 50;
+        auto path = analyzer.reconstructPath(graph.internal_id(u), graph.internal_id(v));
         if (!path.empty()) {
             std::cout << "Path from " << u << " to " << v << ": ";
-            for (int node : path) std::cout << node << " ";
+            for (int node : path) std::cout << graph.external_id(node) << " ";
             std::cout << "\n\n";
         } else {
             std::cout << "No path between " << u << " and " << v << "\n\n";
@@ -169,6 +228,9 @@ int main() {
         // Анализ компонент
         analyzer.analyzeComponents();
 
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
     }
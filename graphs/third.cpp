@@ -1,13 +1,16 @@
 #include <iostream>
 #include <vector>
+#include <iterator>
 #include <queue>
 #include <stack>
 #include <set>
 #include "Graph.h"
+#include "IoStats.h"
 
+template <typename G>
 class SpanningTree {
 private:
-    const Graph& graph_;
+    const G& graph_;
     std::vector<bool> visited_;
     std::vector<std::pair<int, int>> tree_edges_;
     int start_vertex_;
@@ -21,11 +24,12 @@ private:
             int u = q.front();
             q.pop();
 
-            for (int v : graph_.adjacency_list(u)) {
+            for (auto [v, weight] : graph_.neighbors(u)) {
                 if (!visited_[v]) {
                     visited_[v] = true;
                     tree_edges_.emplace_back(u, v);
                     q.push(v);
+                    graph_.prefetch(v);
                 }
             }
         }
@@ -34,8 +38,14 @@ private:
     void dfs(int u) {
         visited_[u] = true;
 
-        for (int v : graph_.adjacency_list(u)) {
+        auto row = graph_.neighbors(u);
+        for (auto it = row.begin(); it != row.end(); ++it) {
+            int v = (*it).vertex;
             if (!visited_[v]) {
+                // Следующего соседа прочитаем после поддерева v — просим подгрузить заранее
+                if (std::next(it) != row.end()) {
+                    graph_.prefetch((*std::next(it)).vertex);
+                }
                 tree_edges_.emplace_back(u, v);
                 dfs(v);
             }
@@ -45,7 +55,7 @@ private:
 public:
     enum Algorithm { BFS, DFS };
 
-    SpanningTree(const Graph& graph, int start_vertex = 1, Algorithm algo = BFS)
+    SpanningTree(const G& graph, int start_vertex = 1, Algorithm algo = BFS)
             : graph_(graph), start_vertex_(start_vertex) {
         if (graph.is_directed()) {
             throw std::invalid_argument("Graph must be undirected for spanning tree");
@@ -72,25 +82,35 @@ public:
     void print_tree() const {
         std::cout << "Spanning tree edges (" << tree_edges_.size() << "):\n";
         for (const auto& edge : tree_edges_) {
-            std::cout << edge.first << " - " << edge.second << "\n";
+            std::cout << graph_.external_id(edge.first) << " - " << graph_.external_id(edge.second) << "\n";
         }
     }
 };
 
-int main() {
+// With a BINARY snapshot as the argument the graph is traversed out of core and
+// the I/O it caused is reported on stderr
+int main(int argc, char* argv[]) {
     try {
-        Graph graph("C:/Users/goddammit/Documents/GitHub/laba2/graphs/list_of_edges_t3_001.txt", Graph::EDGES_LIST);
+        IoCounters before = IoCounters::Sample();
+        Graph graph = argc > 1 ? Graph(argv[1], Graph::BINARY, Graph::EXTERNAL)
+                               : Graph("C:/Users/goddammit/Documents/GitHub/laba2/graphs/list_of_edges_t3_001.txt", Graph::EDGES_LIST);
 
         // Построение BFS-остова
         std::cout << "=== BFS Spanning Tree ===\n";
-        SpanningTree bfs_tree(graph, 1, SpanningTree::BFS);
+        SpanningTree bfs_tree(graph, graph.internal_id(1), SpanningTree<Graph>::BFS);
         bfs_tree.print_tree();
 
         // Построение DFS-остова
         std::cout << "\n=== DFS Spanning Tree ===\n";
-        SpanningTree dfs_tree(graph, 1, SpanningTree::DFS);
+        SpanningTree dfs_tree(graph, graph.internal_id(1), SpanningTree<Graph>::DFS);
         dfs_tree.print_tree();
 
+        if (argc > 1) {
+            (IoCounters::Sample() - before).print(std::cerr);
+        }
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
     }
@@ -5,26 +5,53 @@
 #include <algorithm>
 #include <tuple>
 #include "Graph.h"
+#include "EdgeMap.h"
 
 using namespace std;
 
-int bfs(const vector<vector<int>>& residual_graph, int s, int t, vector<int>& parent) {
-    int n = residual_graph.size() - 1; // Количество вершин (без 0)
+// Capacities are summed in the graph's distance_type (64-bit for integer weights),
+// so neither the residual network nor the total flow can overflow the weight type.
+// Flow is kept per arc in an EdgeMap. The residual capacity of (u, v) is what is
+// left on arc (u, v) plus the flow on (v, u) that can be pushed back, so the
+// network needs no arcs of its own: forward[v] / backward[v] record which arcs
+// the path into v used (G::kNoEdge where there is none).
+template <typename G, typename Flow>
+Flow bfs(const G& graph, const EdgeMap<Flow>& flow, int s, int t, vector<int>& parent,
+         vector<size_t>& forward, vector<size_t>& backward) {
     fill(parent.begin(), parent.end(), -1);
     parent[s] = -2;
-    queue<pair<int, int>> q;
-    q.push({s, numeric_limits<int>::max()});
+    queue<pair<int, Flow>> q;
+    q.push({s, numeric_limits<Flow>::max()});
 
     while (!q.empty()) {
         int u = q.front().first;
-        int flow = q.front().second;
+        Flow path_flow = q.front().second;
         q.pop();
 
-        // Обходим только вершины 1..n
-        for (int v = 1; v <= n; ++v) {
-            if (parent[v] == -1 && residual_graph[u][v] > 0) {
+        // Соседи в обе стороны по возрастанию номера, дуги из u идут в том же порядке
+        auto out_edges = graph.out_edges(u);
+        auto out = out_edges.begin();
+        for (auto [v, weight] : graph.undirected_neighbors(u)) {
+            size_t arc = G::kNoEdge;
+            if (out != out_edges.end() && graph.edge_target(*out) == v) {
+                arc = *out++;
+            }
+            if (parent[v] != -1) {
+                continue;
+            }
+            size_t back = arc != G::kNoEdge ? graph.reverse_edge(arc) : graph.edge_id(v, u);
+            Flow residual = 0;
+            if (arc != G::kNoEdge) {
+                residual += static_cast<Flow>(graph.edge_weight(arc)) - flow[arc];
+            }
+            if (back != G::kNoEdge) {
+                residual += flow[back];
+            }
+            if (residual > 0) {
                 parent[v] = u;
-                int new_flow = min(flow, residual_graph[u][v]);
+                forward[v] = arc;
+                backward[v] = back;
+                Flow new_flow = min(path_flow, residual);
                 if (v == t)
                     return new_flow;
                 q.push({v, new_flow});
@@ -34,44 +61,45 @@ int bfs(const vector<vector<int>>& residual_graph, int s, int t, vector<int>& pa
     return 0;
 }
 
-int ford_fulkerson(const Graph& graph, int s, int t, vector<tuple<int, int, int>>& flow_edges) {
+template <typename G>
+typename G::distance_type ford_fulkerson(const G& graph, int s, int t,
+                                         vector<tuple<int, int, typename G::distance_type>>& flow_edges) {
+    using Flow = typename G::distance_type;
     if (!graph.is_directed())
         throw runtime_error("Flow network must be directed");
 
     int n = graph.size();
-    vector<vector<int>> residual_graph(n + 1, vector<int>(n + 1, 0));
-
-    // Инициализируем остаточную сеть
-    for (int u = 1; u <= n; ++u) {
-        for (int v = 1; v <= n; ++v) {
-            residual_graph[u][v] = graph.weight(u, v);
-        }
-    }
-
+    EdgeMap<Flow> flow(graph, 0);
     vector<int> parent(n + 1);
-    int max_flow = 0;
-    int new_flow;
+    vector<size_t> forward(n + 1), backward(n + 1);
+    Flow max_flow = 0;
+    Flow new_flow;
 
-    while ((new_flow = bfs(residual_graph, s, t, parent))){
+    while ((new_flow = bfs(graph, flow, s, t, parent, forward, backward))){
         max_flow += new_flow;
         int v = t;
 
         while (v != s) {
-            int u = parent[v];
-            residual_graph[u][v] -= new_flow;
-            residual_graph[v][u] += new_flow;
-            v = u;
+            if (forward[v] != G::kNoEdge) {
+                flow[forward[v]] += new_flow;
+            } else {
+                flow[backward[v]] -= new_flow;
+            }
+            v = parent[v];
         }
     }
 
-    // Собираем информацию о потоках
+    // Собираем информацию о потоках: поток по дуге за вычетом встречного
     for (int u = 1; u <= n; ++u) {
-        for (int v = 1; v <= n; ++v) {
-            int capacity = graph.weight(u, v);
-            if (capacity > 0) { // Если ребро существовало в исходном графе
-                int flow_val = capacity - residual_graph[u][v];
+        for (size_t arc : graph.out_edges(u)) {
+            if (graph.edge_weight(arc) > 0) { // Если ребро существовало в исходном графе
+                Flow flow_val = flow[arc];
+                size_t back = graph.reverse_edge(arc);
+                if (back != G::kNoEdge) {
+                    flow_val -= flow[back];
+                }
                 if (flow_val > 0) {
-                    flow_edges.push_back(make_tuple(u, v, flow_val));
+                    flow_edges.push_back(make_tuple(u, graph.edge_target(arc), flow_val));
                 }
             }
         }
@@ -86,18 +114,21 @@ int ford_fulkerson(const Graph& graph, int s, int t, vector<tuple<int, int, int>
 int main() {
     try {
         Graph graph("C:/Users/goddammit/Documents/GitHub/laba2/graphs/list_of_edges_t14_009.txt", Graph::EDGES_LIST); // Убедитесь в правильности пути
-        int source = 176;
-        int sink = 289;
+        int64_t source = 176;
+        int64_t sink = 289;
 
-        vector<tuple<int, int, int>> flow_edges;
-        int maximum_flow = ford_fulkerson(graph, source, sink, flow_edges);
+        vector<tuple<int, int, Graph::distance_type>> flow_edges;
+        auto maximum_flow = ford_fulkerson(graph, graph.internal_id(source), graph.internal_id(sink), flow_edges);
 
         cout << "Maximum flow value: " << maximum_flow << "." << endl;
         cout << "Source: " << source << ", sink: " << sink << "." << endl;
         cout << "Flow:" << endl;
 
         for (const auto& edge : flow_edges) {
-            cout << get<0>(edge) << "-" << get<1>(edge) << " : " << get<2>(edge) << endl;
+            cout << graph.external_id(get<0>(edge)) << "-" << graph.external_id(get<1>(edge)) << " : " << get<2>(edge) << endl;
+        }
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(cerr);
         }
     }
     catch (const exception& e) {
@@ -4,7 +4,8 @@
 #include <stdexcept>
 #include "Graph.h"
 
-std::pair<std::vector<int>, std::vector<int>> checkBipartition(const Graph& graph) {
+template <typename G>
+std::pair<std::vector<int>, std::vector<int>> checkBipartition(const G& graph) {
     int size = graph.size();
     std::vector<int> color(size + 1, 0); // 0 - uncolored, 1 and 2 are colors
     std::queue<int> q;
@@ -16,7 +17,7 @@ std::pair<std::vector<int>, std::vector<int>> checkBipartition(const Graph& grap
             while (!q.empty()) {
                 int current = q.front();
                 q.pop();
-                for (int neighbor : graph.adjacency_list(current)) {
+                for (auto [neighbor, weight] : graph.neighbors(current)) {
                     if (color[neighbor] == 0) {
                         color[neighbor] = (color[current] == 1) ? 2 : 1;
                         q.push(neighbor);
@@ -37,11 +38,12 @@ std::pair<std::vector<int>, std::vector<int>> checkBipartition(const Graph& grap
     return {U, V};
 }
 
-bool dfsKuhn(int u, const Graph& graph, std::vector<int>& match, std::vector<bool>& visited) {
+template <typename G>
+bool dfsKuhn(int u, const G& graph, std::vector<int>& match, std::vector<bool>& visited) {
     if (visited[u]) return false;
     visited[u] = true;
 
-    for (int v : graph.adjacency_list(u)) {
+    for (auto [v, weight] : graph.neighbors(u)) {
         if (match[v] == -1 || dfsKuhn(match[v], graph, match, visited)) {
             match[v] = u;
             return true;
@@ -50,7 +52,8 @@ bool dfsKuhn(int u, const Graph& graph, std::vector<int>& match, std::vector<boo
     return false;
 }
 
-std::pair<int, std::vector<std::pair<int, int>>> findMaxMatching(const Graph& graph) {
+template <typename G>
+std::pair<int, std::vector<std::pair<int, int>>> findMaxMatching(const G& graph) {
     if (graph.is_directed()) {
         throw std::runtime_error("Graph must be undirected for bipartite matching.");
     }
@@ -94,9 +97,12 @@ int main() {
         std::cout << "Size of maximum matching: " << matchingSize << "." << std::endl;
         std::cout << "Maximum matching:\n{";
         for (const auto& edge : matchingPairs) {
-            std::cout << "(" << edge.first << ", " << edge.second << "), ";
+            std::cout << "(" << graph.external_id(edge.first) << ", " << graph.external_id(edge.second) << "), ";
         }
         std::cout << "}" << std::endl;
+        if (GraphStats::Requested()) {
+            graph.stats().print_json(std::cerr);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;